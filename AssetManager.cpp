@@ -0,0 +1,70 @@
+#include "AssetManager.h"
+
+AssetManager::~AssetManager() {
+	waitForPending();
+}
+
+//  Start decoding the given images on worker threads.  Paths that are
+//  already cached or in flight are skipped.
+//
+void AssetManager::preloadImages(const vector<string> &paths) {
+	for (int i = 0; i < paths.size(); i++) {
+		const string &path = paths[i];
+		if (images.count(path) || pending.count(path)) continue;
+		pending[path] = std::async(std::launch::async, [path]() {
+			ofPixels pixels;
+			ofLoadImage(pixels, path);
+			return pixels;
+		});
+	}
+}
+
+//  Return the cached image for path, finishing its decode (or loading it
+//  synchronously if it was never preloaded).  Returns an empty handle if
+//  the image can't be loaded.
+//
+ImageHandle AssetManager::getImage(const string &path) {
+	map<string, ImageHandle>::iterator it = images.find(path);
+	if (it != images.end()) return it->second;
+
+	ImageHandle img;
+	map<string, future<ofPixels>>::iterator p = pending.find(path);
+	if (p != pending.end()) {
+		ofPixels pixels = p->second.get();
+		pending.erase(p);
+		if (pixels.isAllocated()) img.setFromPixels(pixels);
+	}
+	else img.load(path);
+
+	if (!img.isLoaded()) {
+		ofLogError("AssetManager") << "can't load image: " << path;
+		return img;
+	}
+	images[path] = img;
+	return img;
+}
+
+//  Return the shared player for path, loading it the first time.  The
+//  player is returned (unloaded) even on failure so callers can test
+//  isLoaded() instead of checking for null.
+//
+shared_ptr<ofSoundPlayer> AssetManager::getSound(const string &path) {
+	map<string, shared_ptr<ofSoundPlayer>>::iterator it = sounds.find(path);
+	if (it != sounds.end()) return it->second;
+
+	shared_ptr<ofSoundPlayer> sound = make_shared<ofSoundPlayer>();
+	if (!sound->load(path)) {
+		ofLogError("AssetManager") << "can't load sound: " << path;
+	}
+	sounds[path] = sound;
+	return sound;
+}
+
+//  Block until all in-flight decodes are done.
+//
+void AssetManager::waitForPending() {
+	map<string, future<ofPixels>>::iterator p;
+	for (p = pending.begin(); p != pending.end(); p++) {
+		if (p->second.valid()) p->second.wait();
+	}
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "ofMain.h"
+#include "ImageHandle.h"
+
+//  Central registry for images and sounds.
+//
+//  Each path is loaded only once; later requests (including the ones made
+//  when the game is restarted) get the cached handle back.  Images can be
+//  decoded on worker threads ahead of time with preloadImages(); the
+//  texture upload itself happens on the main thread the first time the
+//  image is requested.
+//
+class AssetManager {
+public:
+	~AssetManager();
+	void preloadImages(const vector<string> &paths);
+	ImageHandle getImage(const string &path);
+	shared_ptr<ofSoundPlayer> getSound(const string &path);
+	void waitForPending();
+
+private:
+	map<string, ImageHandle> images;
+	map<string, future<ofPixels>> pending;      // decodes in flight
+	map<string, shared_ptr<ofSoundPlayer>> sounds;
+};
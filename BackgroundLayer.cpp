@@ -0,0 +1,66 @@
+#include "BackgroundLayer.h"
+#include "RenderStats.h"
+#include "Profiler.h"
+
+void BackgroundLayer::setup(const ImageHandle &img, float s) {
+	source = img;
+	speed = s;
+	offset = 0;
+	width = height = 0;     // resample on the next resize()
+}
+
+//  Resample the source to w x h into the layer texture.  Does nothing if
+//  the size hasn't changed, so it is safe to call every frame.
+//
+void BackgroundLayer::resize(int w, int h) {
+	if (!source.isLoaded() || (w == width && h == height)) return;
+	PROFILE_SCOPE("background resample");
+	width = w;
+	height = h;
+
+	ofPixels pixels = source.getImage().getPixels();
+	pixels.resize(w, h);
+	texture.allocate(pixels, false);        // normalized coords so it can repeat
+	texture.loadData(pixels);
+	texture.setTextureWrap(GL_REPEAT, GL_REPEAT);
+
+	// one window sized quad, texture coordinates are filled in by draw()
+	//
+	mesh.clear();
+	mesh.setMode(OF_PRIMITIVE_TRIANGLE_FAN);
+	mesh.addVertex(glm::vec3(0, 0, 0));
+	mesh.addVertex(glm::vec3(w, 0, 0));
+	mesh.addVertex(glm::vec3(w, h, 0));
+	mesh.addVertex(glm::vec3(0, h, 0));
+	for (int i = 0; i < 4; i++) mesh.addTexCoord(glm::vec2(0, 0));
+}
+
+//  Scroll by speed * dt, wrapping at the layer height
+//
+void BackgroundLayer::update(float dt) {
+	offset += speed * dt;
+	if (height > 0) {
+		offset = fmod(offset, float(height));
+		if (offset < 0) offset += height;
+	}
+}
+
+void BackgroundLayer::draw() {
+	if (width == 0 || height == 0) return;
+
+	// the image moves down by "offset", so screen row y shows image row
+	// y - offset; the repeat wrap takes care of the part above the top
+	//
+	float v = -offset / height;
+	vector<glm::vec2> &uv = mesh.getTexCoords();
+	uv[0] = glm::vec2(0, v);
+	uv[1] = glm::vec2(1, v);
+	uv[2] = glm::vec2(1, v + 1);
+	uv[3] = glm::vec2(0, v + 1);
+
+	ofSetColor(ofColor::white);
+	texture.bind();
+	mesh.draw();
+	texture.unbind();
+	renderStats.drawCalls++;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "ofMain.h"
+#include "ImageHandle.h"
+
+//  One vertically scrolling, wrapping background layer.
+//
+//  The source image is resampled to the window size once (and again only
+//  when the window size changes) into the layer's own texture, which uses
+//  a repeating wrap mode.  Scrolling just shifts the texture coordinates
+//  of a single full-window quad, so drawing allocates nothing and costs
+//  one draw call per layer.  Layers with different speeds give parallax.
+//
+class BackgroundLayer {
+public:
+	void setup(const ImageHandle &img, float speed);
+	void resize(int w, int h);
+	void update(float dt);
+	void draw();
+	void reset() { offset = 0; }
+
+	ImageHandle source;     // shared through the AssetManager, never modified
+	float speed = 0;        // pixels/sec, positive scrolls down
+	float offset = 0;       // pixels, 0..height
+
+private:
+	ofTexture texture;
+	ofMesh mesh;
+	int width = 0, height = 0;
+};
@@ -0,0 +1,299 @@
+#include "Benchmark.h"
+#include "ParticleEmitter.h"
+#include "GameSim.h"
+#include "JobSystem.h"
+#include <chrono>
+
+typedef std::chrono::steady_clock BenchClock;
+
+void Benchmark::run(const string &name, int n, function<void()> setup, function<void()> body) {
+	string fullName = name + "/" + ofToString(n);
+	if (!filter.empty() && fullName.find(filter) == string::npos) return;
+
+	// one untimed warm up, then as many timed iterations as fit in minTime
+	//
+	setup();
+	body();
+	double total = 0;
+	int iterations = 0;
+	while (total < minTime * 1e9 && iterations < 1000000) {
+		setup();
+		BenchClock::time_point start = BenchClock::now();
+		body();
+		total += std::chrono::duration<double, std::nano>(BenchClock::now() - start).count();
+		iterations++;
+	}
+
+	Result r;
+	r.name = name;
+	r.n = n;
+	r.iterations = iterations;
+	r.nsPerIter = total / iterations;
+	results.push_back(r);
+	cerr << fullName << ": " << r.nsPerIter / 1000.0 << " us (" << iterations << " iterations)" << endl;
+}
+
+void Benchmark::writeJson(ostream &out) const {
+	out << "{\n  \"benchmarks\": [\n";
+	for (int i = 0; i < results.size(); i++) {
+		const Result &r = results[i];
+		out << "    { \"name\": \"" << r.name << "\", \"n\": " << r.n << ", \"iterations\": " << r.iterations
+			<< ", \"ns_per_iter\": " << r.nsPerIter << ", \"ns_per_entity\": " << r.nsPerIter / r.n << " }"
+			<< (i + 1 < results.size() ? "," : "") << "\n";
+	}
+	out << "  ]\n}" << endl;
+}
+
+static const float fieldWidth = 1334, fieldHeight = 750;
+static const float tickDt = 1 / 60.0;
+
+//  n random immortal particles in the play field
+//
+static void fillParticles(ParticleSystem &sys, FastRandom &rng, int n) {
+	sys.clear();
+	sys.setCapacity(n);
+	for (int i = 0; i < n; i++) {
+		Particle p;
+		p.position.set(rng.uniform(0, fieldWidth), rng.uniform(0, fieldHeight), 0);
+		p.velocity.set(rng.uniform(-100, 100), rng.uniform(-100, 100), 0);
+		p.lifespan = -1;
+		sys.add(p);
+	}
+}
+
+//  n random immortal entities of "team" in the play field
+//
+static void fillWorld(World &world, FastRandom &rng, int n, Team team, float radius) {
+	for (int i = 0; i < n; i++) {
+		int e = world.spawn(team, 0, ofVec2f(rng.uniform(0, fieldWidth), rng.uniform(0, fieldHeight)));
+		world.velocities[e].set(rng.uniform(-100, 100), rng.uniform(-100, 100));
+		world.sprites[e].width = world.sprites[e].height = radius * 2;
+		world.colliders[e].radius = radius;
+	}
+}
+
+//  Runs a force through the default ParticleForce::updateForces()
+//  adapter (gather, updateForce(), scatter) instead of its own batch
+//  kernel
+//
+class AdaptedForce : public ParticleForce {
+public:
+	AdaptedForce(ParticleForce *f) : force(f) { applyOnce = f->applyOnce; }
+	void updateForce(Particle *p) { force->updateForce(p); }
+	void updateForce(Particle *p, FastRandom &rng) { force->updateForce(p, rng); }
+private:
+	ParticleForce *force;
+};
+
+int runBenchmarks(const string &filter) {
+	Benchmark bench;
+	bench.filter = filter;
+	FastRandom rng(1);
+	const int sizes[] = { 100, 1000, 10000, 100000, 1000000 };
+
+	GravityForce gravity(ofVec3f(0, -10, 0));
+	TurbulenceForce turbulence(ofVec3f(-20, -20, -20), ofVec3f(20, 20, 20));
+	ImpulseRadialForce radial(2000.0);
+	ParticleForce *forces[] = { &gravity, &turbulence, &radial };
+
+	// thread counts for the parallel particle update: 1, 2, 4 ... cores
+	//
+	int cores = max(1, int(std::thread::hardware_concurrency()));
+	vector<int> threadCounts;
+	for (int t = 1; t < cores; t *= 2) threadCounts.push_back(t);
+	threadCounts.push_back(cores);
+
+	for (int s = 0; s < 5; s++) {
+		int n = sizes[s];
+
+		// ParticleSystem::update with 0 to 3 forces (the radial impulse
+		// is a one shot force, so it is re-armed for every iteration)
+		//
+		for (int f = 0; f <= 3; f++) {
+			ParticleSystem sys;
+			fillParticles(sys, rng, n);
+			for (int k = 0; k < f; k++) sys.addForce(forces[k]);
+			float now = 0;
+			bench.run("particle_update_forces" + ofToString(f), n,
+				[&]() { sys.reset(); },
+				[&]() { sys.update(tickDt, now); now += tickDt * 1000; });
+		}
+
+		// the same 3 forces through the single particle adapter, to
+		// compare with particle_update_forces3
+		//
+		{
+			AdaptedForce adapted[] = { AdaptedForce(&gravity), AdaptedForce(&turbulence), AdaptedForce(&radial) };
+			ParticleSystem sys;
+			fillParticles(sys, rng, n);
+			for (int k = 0; k < 3; k++) sys.addForce(&adapted[k]);
+			float now = 0;
+			bench.run("particle_update_forces3_adapter", n,
+				[&]() { sys.reset(); },
+				[&]() { sys.update(tickDt, now); now += tickDt * 1000; });
+		}
+
+		// parallel ParticleSystem::update with all 3 forces on 1 to all
+		// cores (same work as particle_update_forces3)
+		//
+		for (int t = 0; t < threadCounts.size(); t++) {
+			jobSystem.setThreads(threadCounts[t]);
+			ParticleSystem sys;
+			fillParticles(sys, rng, n);
+			sys.parallel = true;
+			for (int k = 0; k < 3; k++) sys.addForce(forces[k]);
+			float now = 0;
+			bench.run("particle_update_threads" + ofToString(threadCounts[t]), n,
+				[&]() { sys.reset(); },
+				[&]() { sys.update(tickDt, now); now += tickDt * 1000; });
+		}
+		jobSystem.setThreads(0);
+
+		// ParticleSystem::update where every other particle has expired,
+		// so the timed step also flags and compacts n/2 of them.  The
+		// store is restored (untimed) each iteration.
+		//
+		{
+			ParticleSystem sys;
+			fillParticles(sys, rng, n);
+			for (int i = 0; i < n; i += 2) {
+				sys.particles.birthtime[i] = 0;
+				sys.particles.lifespan[i] = 1;      // sec, over by "now"
+			}
+			ParticleStore store = sys.particles;
+			float now = 2000;
+			bench.run("particle_expire_half", n,
+				[&]() { sys.particles = store; },
+				[&]() { sys.update(tickDt, now); });
+		}
+
+		// ParticleIndex::build over n particles
+		//
+		{
+			ParticleSystem sys;
+			fillParticles(sys, rng, n);
+			ParticleIndex index;
+			bench.run("particle_index_build", n,
+				[]() {},
+				[&]() { index.build(sys.particles, sys.indexCellSize); });
+		}
+
+		// 100 ParticleSystem::queryRadius calls of radius 50 at random
+		// points, on an index that is already built
+		//
+		{
+			ParticleSystem sys;
+			fillParticles(sys, rng, n);
+			vector<ofVec3f> points(100);
+			for (int i = 0; i < points.size(); i++) {
+				points[i].set(rng.uniform(0, fieldWidth), rng.uniform(0, fieldHeight), 0);
+			}
+			vector<int> found;
+			found.reserve(n);
+			bench.run("particle_query_radius", n,
+				[&]() { found.clear(); },
+				[&]() { for (int i = 0; i < points.size(); i++) sys.queryRadius(points[i], 50, found); });
+		}
+
+		// ParticleSystem::removeNear of radius 100 at a random point.  The
+		// store is restored and the index rebuilt (untimed) each
+		// iteration, so only the query and the compaction are timed.
+		//
+		{
+			ParticleSystem sys;
+			fillParticles(sys, rng, n);
+			ParticleStore store = sys.particles;
+			vector<int> found;
+			found.reserve(n);
+			ofVec3f point;
+			bench.run("particle_removeNear", n,
+				[&]() {
+					sys.particles = store;
+					found.clear();
+					sys.queryRadius(ofVec3f(-1000, -1000, 0), 0, found);
+					point.set(rng.uniform(0, fieldWidth), rng.uniform(0, fieldHeight), 0);
+				},
+				[&]() { sys.removeNear(point, 100); });
+		}
+
+		// ParticleEmitter::spawn burst of n particles into an empty pool
+		//
+		{
+			ParticleEmitter emitter;
+			emitter.setEmitterType(RadialEmitter);
+			emitter.setVelocity(ofVec3f(0, 200, 0));
+			emitter.sys->setCapacity(n);
+			bench.run("emitter_spawn_burst", n,
+				[&]() { emitter.sys->clear(); },
+				[&]() { for (int i = 0; i < n; i++) emitter.spawn(0); });
+		}
+
+		// World::update
+		//
+		{
+			World world;
+			world.setCapacity(n);
+			fillWorld(world, rng, n, TeamInvader, 20);
+			float now = 0;
+			bench.run("world_update", n,
+				[]() {},
+				[&]() { world.update(tickDt, now); now += tickDt * 1000; });
+		}
+
+		// World::removeMarked after killing the entities within 30 of a
+		// random point (what sprite_removeNear measured).  Restoring the
+		// world and killing are untimed.
+		//
+		{
+			World world;
+			world.setCapacity(n);
+			fillWorld(world, rng, n, TeamInvader, 20);
+			World saved = world;
+			bench.run("world_removeNear", n,
+				[&]() {
+					world = saved;
+					ofVec2f p(rng.uniform(0, fieldWidth), rng.uniform(0, fieldHeight));
+					for (int i = 0; i < world.size(); i++) {
+						if ((world.transforms[i].position - p).length() < 30) world.kill(i);
+					}
+				},
+				[&]() { world.removeMarked(); });
+		}
+
+		// GameSim::followPaths with n invaders spread over the 4 paths
+		//
+		{
+			GameSim sim;
+			sim.seed = 1;
+			sim.setup(fieldWidth, fieldHeight);
+			sim.world.setCapacity(1 + n);
+			fillWorld(sim.world, rng, n, TeamInvader, 25);
+			for (int i = 1; i < sim.world.size(); i++) sim.world.followers[i].path = i % GameSim::PathCount;
+			bench.run("invader_paths", n,
+				[]() {},
+				[&]() { sim.followPaths(tickDt); });
+		}
+
+		// GameSim::checkCollisions with n invaders and n/10 missiles (at
+		// least one); the world is restored (untimed) each iteration
+		//
+		{
+			GameSim sim;
+			sim.seed = 1;
+			sim.setup(fieldWidth, fieldHeight);
+			sim.world.setCapacity(1 + n + max(1, n / 10));
+			fillWorld(sim.world, rng, n, TeamInvader, 25);
+			fillWorld(sim.world, rng, max(1, n / 10), TeamMissile, 5);
+			World world = sim.world;
+			bench.run("collisions", n,
+				[&]() {
+					sim.world = world;
+					sim.events.clear();
+				},
+				[&]() { sim.checkCollisions(0); });
+		}
+	}
+
+	bench.writeJson(cout);
+	return 0;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include "ofMain.h"
+
+//  Minimal benchmark runner for the simulation hot paths (particles,
+//  sprites, collisions).  Needs no window; run with main --bench.
+//
+//  Each case is run with a setup function (not timed) and a body (timed)
+//  for at least minTime seconds.  Results are written as JSON so runs can
+//  be compared by a script.
+//
+class Benchmark {
+public:
+	struct Result {
+		string name;
+		int n;                  // entities in the case
+		int iterations;
+		double nsPerIter;
+	};
+
+	void run(const string &name, int n, function<void()> setup, function<void()> body);
+	void writeJson(ostream &out) const;
+
+	string filter;              // only run cases whose name contains this
+	double minTime = 0.2;       // seconds per case
+	vector<Result> results;
+};
+
+//  Run every case from 100 to 1M entities, JSON to stdout
+//
+int runBenchmarks(const string &filter);
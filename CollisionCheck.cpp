@@ -0,0 +1,94 @@
+#include "CollisionCheck.h"
+#include "GameSim.h"
+
+static const float fieldWidth = 1334, fieldHeight = 750;
+
+//  n entities of "team" scattered around "center", some of them off the
+//  play field
+//
+static void scatter(GameSim &sim, FastRandom &rng, int n, Team team, const ofVec2f &center, float spread) {
+	for (int i = 0; i < n; i++) {
+		ofVec2f p = center + ofVec2f(rng.uniform(-spread, spread), rng.uniform(-spread, spread));
+		int kind = team == TeamInvader ? int(rng.next() % GameSim::InvaderKinds) : 0;
+		int e = sim.world.spawn(team, kind, p);
+		float radius = team == TeamMissile ? 5 : team == TeamBonus ? 37.5 : rng.uniform(5, 40);
+		sim.world.colliders[e].radius = radius;
+		sim.world.sprites[e].width = sim.world.sprites[e].height = radius * 2;
+	}
+}
+
+//  Replace everything but the ship with a random scene.  Entities are
+//  packed into a few clusters, one of them on the ship, so that missiles
+//  hit several invaders of several kinds and the ship gets hit too.
+//
+static void buildScene(GameSim &sim, FastRandom &rng) {
+	World &world = sim.world;
+	for (int i = 0; i < world.size(); i++) {
+		if (i != sim.gun) world.kill(i);
+	}
+	world.removeMarked();
+
+	ofVec2f gunPos(rng.uniform(-50, fieldWidth + 50), rng.uniform(-50, fieldHeight + 50));
+	world.transforms[sim.gun].position = gunPos;
+	scatter(sim, rng, int(rng.next() % 4), TeamBonus, gunPos, 120);
+	scatter(sim, rng, int(rng.next() % 20), TeamInvader, gunPos, 150);
+
+	int clusters = 1 + int(rng.next() % 8);
+	for (int c = 0; c < clusters; c++) {
+		ofVec2f center(rng.uniform(-100, fieldWidth + 100), rng.uniform(-100, fieldHeight + 100));
+		float spread = rng.uniform(20, 300);
+		scatter(sim, rng, int(rng.next() % 100), TeamInvader, center, spread);
+		scatter(sim, rng, int(rng.next() % 30), TeamMissile, center, spread);
+	}
+	scatter(sim, rng, int(rng.next() % 50), TeamInvader, ofVec2f(fieldWidth / 2, fieldHeight / 2), fieldWidth);
+	scatter(sim, rng, int(rng.next() % 20), TeamMissile, ofVec2f(fieldWidth / 2, fieldHeight / 2), fieldWidth);
+}
+
+int runCollisionCheck(int scenes) {
+	GameSim sim;
+	sim.seed = 1;
+	sim.setup(fieldWidth, fieldHeight);
+	sim.world.setCapacity(4096);    // scenes are bigger than a game
+	FastRandom rng(1);
+
+	int failed = 0;
+	for (int s = 0; s < scenes; s++) {
+		buildScene(sim, rng);
+		sim.score = int(rng.next() % 100);
+		sim.gunLife = int(rng.next() % 5);
+
+		// what the reference says is left
+		//
+		int expectScore = sim.score;
+		int expectLife = sim.gunLife;
+		int expectAliens = 0;
+		vector<char> removed;
+		sim.checkCollisionsBruteForce(expectScore, expectLife, expectAliens, &removed);
+		World expect;
+		for (int i = 0; i < sim.world.size(); i++) {
+			if (removed[i]) continue;
+			expect.spawn(sim.world.tags[i].team, sim.world.tags[i].kind, sim.world.transforms[i].position);
+		}
+		int n = sim.world.size();
+
+		sim.checkCollisions(0);
+		sim.events.clear();
+
+		// removeMarked() is stable, so the survivors must match in order
+		//
+		World &world = sim.world;
+		bool same = world.size() == expect.size();
+		for (int i = 0; same && i < world.size(); i++) {
+			same = world.tags[i].team == expect.tags[i].team && world.tags[i].kind == expect.tags[i].kind &&
+				world.transforms[i].position == expect.transforms[i].position;
+		}
+		if (!same || sim.score != expectScore || sim.gunLife != expectLife) {
+			ofLogError("CollisionCheck") << "scene " << s << " (" << n << " entities): score " << sim.score << "/"
+				<< expectScore << " lives " << sim.gunLife << "/" << expectLife << " entities left " << world.size()
+				<< "/" << expect.size() << (same ? "" : ", different entities");
+			failed++;
+		}
+	}
+	cout << scenes << " scenes, " << failed << " mismatches" << endl;
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include "ofMain.h"
+
+//  Differential test of the collision code: builds random scenes of
+//  invaders, missiles and bonus pills around the ship, runs the grid
+//  GameSim::checkCollisions() and the brute force reference on each and
+//  compares the score, lives and the entities left.  Needs no window;
+//  run with main --check-collisions.
+//
+//  Returns 0 if every scene matched, 1 otherwise.
+//
+int runCollisionCheck(int scenes);
@@ -0,0 +1,18 @@
+#pragma once
+#include "ofMain.h"
+
+//  Remove every element i with dead[i] set in a single pass, keeping
+//  the survivors in order.  World and ParticleStore keep one array per
+//  field and compact each of them with the same "dead" flags.
+//
+template <class Array>
+void compactArray(Array &a, const vector<char> &dead) {
+	int n = int(a.size());
+	int w = 0;
+	for (int r = 0; r < n; r++) {
+		if (dead[r]) continue;
+		if (w != r) a[w] = std::move(a[r]);
+		w++;
+	}
+	a.erase(a.begin() + w, a.end());
+}
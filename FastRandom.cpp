@@ -0,0 +1,98 @@
+#include "FastRandom.h"
+
+static uint64_t splitmix64(uint64_t &x) {
+	uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+static inline uint32_t rotl(uint32_t x, int k) {
+	return (x << k) | (x >> (32 - k));
+}
+
+//  map the top 24 bits of a random integer to a float in [0, 1)
+//
+static inline float toUnit(uint32_t x) {
+	return (x >> 8) * (1.0f / 16777216.0f);
+}
+
+FastRandom::FastRandom(uint64_t s) {
+	seed(s);
+}
+
+//  Initialize all lanes from one 64 bit seed (via splitmix64, so nearby
+//  seeds still give unrelated streams)
+//
+void FastRandom::seed(uint64_t s) {
+	for (int l = 0; l < Lanes; l++) {
+		uint64_t a = splitmix64(s);
+		uint64_t b = splitmix64(s);
+		s0[l] = uint32_t(a);
+		s1[l] = uint32_t(a >> 32);
+		s2[l] = uint32_t(b);
+		s3[l] = uint32_t(b >> 32);
+	}
+	buffered = 0;
+}
+
+//  Advance every lane once (xoshiro128+)
+//
+void FastRandom::step(uint32_t out[Lanes]) {
+	for (int l = 0; l < Lanes; l++) {
+		out[l] = s0[l] + s3[l];
+		uint32_t t = s1[l] << 9;
+		s2[l] ^= s0[l];
+		s3[l] ^= s1[l];
+		s1[l] ^= s2[l];
+		s0[l] ^= s3[l];
+		s2[l] ^= t;
+		s3[l] = rotl(s3[l], 11);
+	}
+}
+
+uint32_t FastRandom::next() {
+	if (buffered == 0) {
+		step(buffer);
+		buffered = Lanes;
+	}
+	return buffer[--buffered];
+}
+
+float FastRandom::uniform() {
+	return toUnit(next());
+}
+
+float FastRandom::uniform(float min, float max) {
+	return min + (max - min) * uniform();
+}
+
+//  Fill out[0..n) with uniform floats in [min, max)
+//
+void FastRandom::fillUniform(float *out, int n, float min, float max) {
+	float range = max - min;
+	uint32_t r[Lanes];
+	int i = 0;
+	for (; i + Lanes <= n; i += Lanes) {
+		step(r);
+		for (int l = 0; l < Lanes; l++) out[i + l] = min + range * toUnit(r[l]);
+	}
+	for (; i < n; i++) out[i] = uniform(min, max);
+}
+
+//  Fill x/y/z[0..n) with normalized random directions.  Each component
+//  is first drawn uniformly from [-extent, extent] (the same distribution
+//  as normalizing an ofRandom() vector); zero vectors stay zero.
+//
+void FastRandom::fillDirections(float *x, float *y, float *z, int n, const ofVec3f &extent) {
+	fillUniform(x, n, -extent.x, extent.x);
+	fillUniform(y, n, -extent.y, extent.y);
+	fillUniform(z, n, -extent.z, extent.z);
+	for (int i = 0; i < n; i++) {
+		float len = sqrtf(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+		float s = len > 0 ? 1.0f / len : 0;
+		x[i] *= s;
+		y[i] *= s;
+		z[i] *= s;
+	}
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include "ofMain.h"
+
+//  Small, fast, seedable random number generator (xoshiro128+).
+//
+//  Four independent generator lanes are stepped together so the bulk
+//  fill functions work on plain arrays the compiler can vectorize.  Each
+//  ParticleSystem (and the game itself) owns one, so there's no shared
+//  global state and a run can be reproduced from its seed.
+//
+class FastRandom {
+public:
+	FastRandom(uint64_t seed = 1);
+	void seed(uint64_t s);
+
+	uint32_t next();
+	float uniform();                            // [0, 1)
+	float uniform(float min, float max);        // [min, max)
+
+	void fillUniform(float *out, int n, float min, float max);
+	void fillDirections(float *x, float *y, float *z, int n, const ofVec3f &extent);
+
+private:
+	enum { Lanes = 4 };
+	void step(uint32_t out[Lanes]);
+
+	uint32_t s0[Lanes], s1[Lanes], s2[Lanes], s3[Lanes];
+	uint32_t buffer[Lanes];     // outputs handed out one at a time by next()
+	int buffered;
+};
@@ -0,0 +1,911 @@
+#include "GameSim.h"
+#include "Profiler.h"
+#include "JobSystem.h"
+#include <chrono>
+
+GameSim::~GameSim() {
+	freeObjects();
+}
+
+//  Job i of the update in simulate(): the three particle effects, then
+//  the world
+//
+void GameSim::updateJob(int i) {
+	switch (i) {
+	case 0:
+		// explosion effects when an invader is defeated
+		expEmit.update(stepDt, stepNow);
+		break;
+	case 1:
+		// explosion effects when the gun is defeated
+		expEmitShip.update(stepDt, stepNow);
+		break;
+	case 2:
+		// thruster effect as the ship flies up
+		thrusterShip.update(stepDt, stepNow);
+		break;
+	default:
+		updateWorld(stepDt, stepNow);
+		break;
+	}
+}
+
+//  Delete the forces made by the last setup()
+//
+void GameSim::freeObjects() {
+	world.clear();
+
+	expEmit.sys->forces.clear();
+	expEmitShip.sys->forces.clear();
+	thrusterShip.sys->forces.clear();
+	delete turbForce;
+	delete gravityForce;
+	delete radialForce;
+	turbForce = NULL;
+	gravityForce = NULL;
+	radialForce = NULL;
+}
+
+void GameSim::emit(GameEventType type, const ofVec3f &position) {
+	GameEvent e;
+	e.type = type;
+	e.position = position;
+	events.push_back(e);
+}
+
+//  Set up a new game on a w x h play field.  Also used to restart.  Sprite
+//  sizes are fixed here, images only come from "images" when given.
+//
+void GameSim::setup(float w, float h, ImageSource images) {
+	width = w;
+	height = h;
+	freeObjects();          // setup() is run again on restart
+	events.clear();
+
+	// a restart starts from tick 0 with nothing left of the last game,
+	// like a new GameSim, so a game recorded after a restart replays the
+	// same (main.cpp --replay)
+	//
+	clock.reset();
+	playtime = 0;
+	gameStartTime = 0;
+	currentplaytime = 0;
+	levelup = false;
+	moveDir = MoveStop;
+	move = 0;
+	ParticleEmitter *effects[] = { &expEmit, &expEmitShip, &thrusterShip };
+	for (int i = 0; i < 3; i++) {
+		effects[i]->stop();
+		effects[i]->sys->clear();
+	}
+
+	// seed the game and particle system generators.  Without a requested
+	// seed every game (including restarts) gets a fresh one.
+	//
+	usedSeed = seed ? seed : uint64_t(std::chrono::system_clock::now().time_since_epoch().count());
+	ofLogNotice("GameSim") << "random seed " << usedSeed;
+	rng.seed(usedSeed);
+	expEmit.sys->rng.seed(usedSeed + 1);
+	expEmitShip.sys->rng.seed(usedSeed + 2);
+	thrusterShip.sys->rng.seed(usedSeed + 3);
+
+	auto image = [&](const string &name) {
+		return images ? images(name) : -1;
+	};
+
+	// set up play area for the turret or ship
+	playarea = ofRectangle(20,20,width-20, height-20);
+
+	// room for well above the number of entities ever alive at once, so
+	// spawning doesn't allocate during play
+	//
+	world.setCapacity(512);
+
+	// Set up the gun (100x100 ship) and its missiles (10x10).  The ship
+	// is drawn at its image size, and not at all without one
+	//
+	gun = world.spawn(TeamPlayer, 0, ofVec2f(width / 2.0, height));
+	int gunImage = image("rocket");
+	world.sprites[gun].image = gunImage;
+	world.sprites[gun].width = gunImage >= 0 ? 100 : 0;
+	world.sprites[gun].height = gunImage >= 0 ? 100 : 0;
+	world.colliders[gun].radius = 100 / 2;
+	shipVerVelocity = glm::vec3(0, 0, 0);
+	shipHorVelocity = glm::vec3(0, 0, 0);
+	shipAcceleration = glm::vec3(0, 0, 0);
+	shipSpeed = glm::length(shipVerVelocity);
+	shipDamping = 0.99;
+
+	missiles = Spawner();
+	missiles.team = TeamMissile;
+	missiles.image = image("missle");
+	missiles.width = 10;
+	missiles.height = 10;
+	missiles.velocity = glm::vec3(0, -1000, 0);
+	missiles.rate = 3;
+	missiles.lifespan = height; //ms
+
+	// Set up  the bonus launcher
+	// the pill is drawn at 50x50 but collides as if it were 75x75
+	//
+	bonus = Spawner();
+	bonus.team = TeamBonus;
+	bonus.image = image("pill");
+	bonus.width = 75;
+	bonus.height = 75;
+	bonus.position.set(rng.uniform(0,width), 0);
+	bonus.velocity = glm::vec3(0, 200, 0);
+	bonus.maxCount = 1;
+	bonus.lifespan = 7000; //ms
+
+	// Set up some reasonable parameters for the invader spirtes: where
+	// they come from, speed, lifespan (ms), rate and size.  Images are
+	// drawn at the collision size.
+	//
+	struct { float x, y, speed, lifespan, rate, size; } kinds[InvaderKinds] = {
+		{ width / 2, 10, 200, 5000, 1, 50 },
+		{ width / 3, 10, 300, 7000, 0.5, 40 },
+		{ width, height / 3, 400, 7000, 0.5, 50 },
+		{ width / 3, 10, 500, 7000, 0.5, 40 },
+		{ 0, height * 2 / 3, 400, 7000, 0.5, 50 },
+	};
+	for (int i = 0; i < InvaderKinds; i++) {
+		Spawner &s = invaders[i];
+		s = Spawner();
+		s.team = TeamInvader;
+		s.kind = i;
+		s.position.set(kinds[i].x, kinds[i].y);
+		s.velocity = glm::vec3(0, kinds[i].speed, 0);
+		s.lifespan = kinds[i].lifespan;
+		s.rate = currentplaytime / (1000 * 60)*0.1 + kinds[i].rate;
+		s.width = s.height = kinds[i].size;
+		s.image = image("alien" + ofToString(i + 1));
+		s.path = i == 0 ? -1 : PathInvader2 + i - 1;
+	}
+	invading = true;
+
+
+	// set up the emitter forces
+	//
+	turbForce = new TurbulenceForce(ofVec3f(-20, -20, -20), ofVec3f(20, 20, 20));
+	gravityForce = new GravityForce(ofVec3f(0, -10, 0));
+	radialForce = new ImpulseRadialForce(2000.0);
+
+	// fixed particle pools, sized for the worst case seen in play so the
+	// particle systems never allocate during the game.  Explosions that
+	// pile up replace the oldest sparks instead of growing the pool.
+	//
+	expEmit.sys->setCapacity(500, OverflowRecycleOldest);
+	expEmitShip.sys->setCapacity(200, OverflowDrop);
+	thrusterShip.sys->setCapacity(400, OverflowRecycleOldest);
+
+	// set up the explosion force of invaders
+
+	expEmit.sys->addForce(turbForce);
+	expEmit.sys->addForce(gravityForce);
+	expEmit.sys->addForce(radialForce);
+
+	expEmit.setPosition(ofVec3f(width/2, height/2, 0));
+	expEmit.setOneShot(true);
+	expEmit.setEmitterType(RadialEmitter);
+	expEmit.setGroupSize(50);
+	expEmit.setLifespan(0.5);
+	expEmit.setVelocity(ofVec3f(0, 200, 0));
+	expEmit.setRate(5.0);
+	expEmit.setParticleRadius(1);
+
+	// set up the explosion effect for the ship
+
+	expEmitShip.sys->addForce(turbForce);
+	expEmitShip.sys->addForce(gravityForce);
+	expEmitShip.sys->addForce(radialForce);
+
+	expEmitShip.setOneShot(true);
+	expEmitShip.setEmitterType(RadialEmitter);
+	expEmitShip.setGroupSize(100);
+	expEmitShip.setLifespan(1);
+	expEmitShip.setVelocity(ofVec3f(0, 400, 0));
+	expEmitShip.setRate(5.0);
+	expEmitShip.setParticleRadius(2);
+
+	// set up thruster fire effect for the ship
+	thrusterShip.sys->addForce(turbForce);
+	thrusterShip.sys->addForce(gravityForce);
+
+	thrusterShip.setPosition(world.transforms[gun].position);
+	thrusterShip.setEmitterType(DiscEmitter);
+	thrusterShip.setGroupSize(100);
+	thrusterShip.setLifespan(0.5);
+	thrusterShip.setVelocity(ofVec3f(0, 100, 0));
+	thrusterShip.setRate(5.0);
+	thrusterShip.radius = 5;
+	thrusterShip.setParticleRadius(1);
+	thrusterShip.start(clock.getNow());
+
+	// start program with an idle mode only start when the space bar is pressed the first time
+	startAnim = false;
+	gameOver = false;
+	score = 0; // restart score
+	hit = 0; // restart gun hitted number
+	gunLife = 3; // set player health = 3 lives
+	level = 0;
+	bakePaths();
+}
+
+//  The play field changed size: paths follow the new size right away,
+//  spawn points on the next setup()
+//
+void GameSim::resize(float w, float h) {
+	width = w;
+	height = h;
+	playarea = ofRectangle(20,20,width-20, height-20);
+	bakePaths();
+}
+
+//  Bake the paths of invaders 2 to 5 for the play field and level.  Each
+//  one crosses the field at 2 pixels per 1/60 sec along its main axis,
+//  the same pace they followed their curves at before the paths were
+//  baked; along the path they move at a steady speed.
+//
+void GameSim::bakePaths() {
+	PROFILE_SCOPE("bakePaths");
+	float w = width, h = height;
+	float cross = 120;      // pixels/sec along the axis
+	int cycles = level;
+
+	// invader 2: down the middle, swinging 150 pixels 2 times
+	paths.set(PathInvader2, PathEngine::bake([w, h](float t) {
+		float y = t * h;
+		return ofVec2f(-150 * sin(4 * y * PI / h) + w / 2, y);
+	}, h / cross));
+
+	// invader 3: right to left through the middle, swinging 100 pixels
+	paths.set(PathInvader3, PathEngine::bake([w, h](float t) {
+		float x = (1 - t) * w;
+		return ofVec2f(x, -100 * sin(4 * x * PI / w) + h / 2);
+	}, w / cross));
+
+	// invader 4: down, wiggling 50 pixels 5 times
+	paths.set(PathInvader4, PathEngine::bake([w, h](float t) {
+		float y = t * h;
+		return ofVec2f(-50 * sin(10 * y * PI / h) + w / 2, y);
+	}, h / cross));
+
+	// invader 5: left to right, wiggling 10 pixels once per level
+	paths.set(PathInvader5, PathEngine::bake([w, h, cycles](float t) {
+		float x = t * w;
+		return ofVec2f(x, -10 * sin(cycles * x * PI / w) + h / 2);
+	}, w / cross));
+
+	pathLevel = level;
+}
+
+//  Run as many fixed ticks as "elapsed" real seconds call for
+//
+void GameSim::update(float elapsed) {
+	clock.advance(elapsed);
+	while (clock.step()) {
+		simulate(clock.getDt(), clock.getNow());
+	}
+}
+
+void GameSim::tick() {
+	update(clock.getDt());
+}
+
+//  Advance the game by one fixed tick. dt is the tick length in seconds,
+//  now the simulation time in ms.  Nothing below reads the wall clock,
+//  the frame rate or the window.
+//
+void GameSim::simulate(float dt, float now) {
+	PROFILE_SCOPE("simulate");
+	world.savePositions();
+	if (startAnim) {
+		ofVec2f &gunPos = world.transforms[gun].position;
+		switch (moveDir)
+		{
+		case MoveUp:
+			move = 1;
+			shipAcceleration =glm::vec3(0,250,0);
+			shipVerVelocity += shipAcceleration * dt;
+			gunPos -= shipVerVelocity * dt;
+			break;
+		case MoveDown:
+			move = 2;
+			shipAcceleration = glm::vec3(0, 250, 0);
+			shipVerVelocity += shipAcceleration * dt;
+			gunPos += shipVerVelocity * dt;
+			break;
+		case MoveLeft:
+			move =3;
+			shipAcceleration = glm::vec3(250, 0, 0);
+			shipHorVelocity += shipAcceleration * dt;
+			gunPos -= shipHorVelocity * dt;
+			break;
+		case MoveRight:
+			move = 4;
+			shipAcceleration = glm::vec3(250, 0, 0);
+			shipHorVelocity += shipAcceleration * dt;
+			gunPos += shipHorVelocity * dt;
+			break;
+		case MoveStop:
+
+			shipAcceleration = glm::vec3(0, 0, 0);
+			if (glm::length(shipVerVelocity) >shipSpeed) {
+				shipVerVelocity = shipVerVelocity * shipDamping;
+				if (move == 1 ) { //move foward
+					gunPos -=shipVerVelocity * dt;
+				}
+				if (move == 2 ) { //move backward
+					gunPos += shipVerVelocity * dt;
+				}
+
+			}
+			if (glm::length(shipHorVelocity) > shipSpeed) {
+				shipHorVelocity = shipHorVelocity * shipDamping;
+				if (move == 3) { //move left
+					gunPos -= shipHorVelocity * dt;
+				}
+				if (move == 4) { //move right
+					gunPos += shipHorVelocity * dt;
+				}
+			}
+			break;
+		}
+
+	}
+
+
+	// The particle effects and the world don't touch each other until the
+	// collision check, so they update as parallel jobs, joined before
+	// checkCollisions().  Invaders due at this level that haven't
+	// started yet start first.
+	//
+	if (startAnim) {
+		for (int i = 0; i < activeInvaders(); i++) {
+			if (!invaders[i].started) invaders[i].start(now);
+		}
+	}
+	{
+		PROFILE_SCOPE("emitters");
+		stepDt = dt;
+		stepNow = now;
+		jobSystem.parallelFor(4, [this](int i) { updateJob(i); });
+	}
+
+	// spawning may have grown the world, so look the ship up again
+	//
+	ofVec2f &gunPos = world.transforms[gun].position;
+
+	// thruster effect follows the tail of the ship
+	thrusterShip.setPosition(gunPos);
+
+
+	// Every 3 level up, the gun rate will increase 15%
+	if (level % 3 == 0) {
+		if (levelup) {
+			missiles.rate *= 1.5;
+			emit(EventLevelUp, gunPos);
+			levelup = false;
+		}
+	}
+	else {
+		levelup = true;
+	}
+
+	if (!startAnim) {
+		gunPos.y -= 3;
+		if (gunPos.y <= (height * 2 / 3)) {
+			gunPos.y = (height * 2 / 3);
+		}
+	}
+
+	// check for collisions between missles and invaders
+	//
+	checkCollisions(now);
+
+
+	// we will randomize initial velocity so that not the invaders
+
+
+	{
+		PROFILE_SCOPE("invader paths");
+
+		// new invaders 1 get a random sideways speed and come from a
+		// random point along the top, 2 and 3 from a random point too
+		//
+		ofVec3f v = invaders[0].velocity;
+		invaders[0].velocity = glm::vec3(rng.uniform(-v.y / 2, v.y / 2), v.y, v.z);
+		invaders[0].position.x = rng.uniform(0, width);
+		invaders[1].position.x = rng.uniform(0, width);
+		invaders[2].position.y = rng.uniform(0, height * 3 / 4);
+		invaders[4].position.y = rng.uniform(height/4, height*3/4);
+
+		// invaders 2 to 5 follow their paths
+		//
+		if (level != pathLevel) bakePaths();
+		followPaths(dt);
+	}
+
+	// game runs until all lives of gun run out
+	//
+	float t = now;
+	if (startAnim) {
+		if (gunLife == 0) {
+			gunLife = -1;
+			// ship explosion
+			expEmitShip.setPosition(gunPos);
+			expEmitShip.start(now);
+			emit(EventShipDestroyed, gunPos);
+			thrusterShip.stop();
+			missiles.stop();
+			emit(EventFireStop, gunPos);
+
+			//set gameOver
+			gameOver = true;
+
+			playtime = (t - gameStartTime) / 1000;
+
+			// remove all the invaders
+			invading = false;
+			world.killTeam(TeamInvader);
+			world.removeMarked();
+
+		}
+	}
+
+
+	//check for playing area bound
+	if (gunPos.x < playarea.getLeft()) {
+		gunPos.x = playarea.getLeft();
+	}
+	else if (gunPos.x > playarea.getRight()) {
+		gunPos.x = playarea.getRight();
+	}
+	if (gunPos.y > playarea.getBottom()) {
+		gunPos.y = playarea.getBottom();
+	}
+	else if (gunPos.y < playarea.getTop()) {
+		gunPos.y = playarea.getTop();
+	}
+
+	// level is calculate as quotient of 20
+	level = score/10 + 1;
+	if (startAnim) {
+		t = now;
+		currentplaytime = t - gameStartTime;
+
+		//set up bonus life
+		bonus.position.set(rng.uniform(0, width), 0);
+
+		//every 20 seconds there will  be a bonus item drop down
+		if (int(currentplaytime) % 20000 <= 20) {
+			dropBonus();
+		}
+	}
+
+}
+
+//  Advance every entity on a path by one tick: the velocity is set so
+//  the next World::update() lands it on the path "dt" further along
+//
+void GameSim::followPaths(float dt) {
+	for (int i = 0; i < world.size(); i++) {
+		World::PathFollower &f = world.followers[i];
+		if (f.path < 0) continue;
+		const PathTable &table = paths.get(f.path);
+		f.distance += table.speed * dt;
+		ofVec2f next = table.at(f.distance) + f.offset;
+		world.velocities[i] = (next - world.transforms[i].position) / dt;
+	}
+}
+
+//  The spawner the entity came from, NULL for the ship
+//
+Spawner *GameSim::spawnerOf(int entity) {
+	const World::Tag &tag = world.tags[entity];
+	switch (tag.team) {
+	case TeamMissile:
+		return &missiles;
+	case TeamInvader:
+		return &invaders[tag.kind];
+	case TeamBonus:
+		return &bonus;
+	default:
+		return NULL;
+	}
+}
+
+//  Add an entity from s if one is due at "now" (ms).  An entity on a
+//  path starts the path where it spawns and heads along it in this
+//  tick's move.
+//
+void GameSim::spawnFrom(Spawner &s, float dt, float now) {
+	if (!s.started) return;
+	ofVec2f position;
+	if (s.maxCount >= 0) {
+		if (s.count >= s.maxCount) return;
+		position = s.position;
+	}
+	else {
+		if ((now - s.lastSpawned) <= (1000.0 / s.rate)) return;
+		//entity starts from the top of the spawner, not in the middle
+		glm::vec3 offset = glm::normalize(s.velocity) * 30;
+		position = s.position + ofVec2f(offset.x, offset.y);
+	}
+	int e = world.spawn(s.team, s.kind, position);
+	if (e < 0) return;              // world full, try again next tick
+	if (s.maxCount >= 0) s.count += 1;
+	world.velocities[e] = s.velocity;
+	world.lifetimes[e].birthtime = now;
+	world.lifetimes[e].lifespan = s.lifespan;
+	world.sprites[e].image = s.image;
+	world.sprites[e].width = s.width;
+	world.sprites[e].height = s.height;
+	world.colliders[e].radius = s.height / 2;
+	if (s.path >= 0) {
+		const PathTable &table = paths.get(s.path);
+		World::PathFollower &f = world.followers[e];
+		f.path = s.path;
+		f.offset = position - table.at(0);
+		f.distance = table.speed * dt;
+		world.velocities[e] = (table.at(f.distance) - table.at(0)) / dt;
+	}
+	s.lastSpawned = now;
+}
+
+//  Spawn, expire and move every entity.  Entities of a spawner that is
+//  updated but stopped are removed: missiles when the gun stops firing,
+//  invaders and the bonus only once the game has started.
+//
+void GameSim::updateWorld(float dt, float now) {
+	PROFILE_SCOPE("World::update");
+	for (int i = 0; i < world.size(); i++) {
+		Spawner *s = spawnerOf(i);
+		if (!s || s->started) continue;
+		if (s == &missiles || startAnim) world.kill(i);
+	}
+
+	// missiles leave from the ship
+	//
+	missiles.position = world.transforms[gun].position;
+	spawnFrom(missiles, dt, now);
+	if (startAnim) {
+		for (int i = 0; i < activeInvaders(); i++) spawnFrom(invaders[i], dt, now);
+		spawnFrom(bonus, dt, now);
+	}
+	world.update(dt, now);
+}
+
+//  Mark every live entity of "team" within radius (plus its own) of p as
+//  killed, using the grid built by checkCollisions().  Returns how many
+//  were newly marked and sets a bit in "kinds" for each kind hit.
+//
+int GameSim::markNear(const ofVec2f &p, float radius, Team team, int &kinds) {
+	candidates.clear();
+	grid.query(p, radius + maxTargetRadius, candidates);
+	int count = 0;
+	for (int k = 0; k < candidates.size(); k++) {
+		int i = candidates[k];
+		if (targetDead[i]) continue;
+		const Target &t = targets[i];
+		if (t.team != team) continue;
+		if ((t.position - p).length() >= radius + t.radius) continue;
+		targetDead[i] = 1;
+		world.kill(t.entity);
+		kinds |= 1 << t.kind;
+		count++;
+	}
+	return count;
+}
+
+//  Number of invader kinds set in a markNear() result
+//
+static int countKinds(int kinds) {
+	int n = 0;
+	for (; kinds; kinds &= kinds - 1) n++;
+	return n;
+}
+
+//  Collision check using a uniform grid over the invaders and bonus
+//  pills.  For each missle check to see which invaders you hit and remove
+//  them.  Each test only looks at the entities in nearby grid cells; the
+//  result is the same as the O(M x N) loops kept in
+//  checkCollisionsBruteForce().  main --check-collisions compares the two
+//  on random scenes; define COLLISION_DIFF_CHECK to compare them every
+//  tick of a game.
+//
+//  A missile scores once for each type of invader it hits, and the ship
+//  loses a life for each type that hits it.
+//
+void GameSim::checkCollisions(float now) {
+	PROFILE_SCOPE("collisions");
+
+#ifdef COLLISION_DIFF_CHECK
+	int expectScore = score;
+	int expectLife = gunLife;
+	int expectAliens = 0;
+	checkCollisionsBruteForce(expectScore, expectLife, expectAliens);
+#endif
+
+	// grid covers the play field; entities outside it land in the border
+	// cells
+	//
+	grid.setup(ofRectangle(0, 0, width, height), 64);
+	targets.clear();
+	maxTargetRadius = 0;
+	for (int i = 0; i < world.size(); i++) {
+		const World::Tag &tag = world.tags[i];
+		if (tag.team != TeamInvader && tag.team != TeamBonus) continue;
+		Target t;
+		t.position = world.transforms[i].position;
+		t.radius = world.colliders[i].radius;
+		t.entity = i;
+		t.team = tag.team;
+		t.kind = tag.kind;
+		grid.insert(t.position);
+		targets.push_back(t);
+		maxTargetRadius = max(maxTargetRadius, t.radius);
+	}
+	grid.build();
+	targetDead.assign(targets.size(), 0);
+
+	// the ship picks up bonus pills
+	//
+	ofVec2f gunPos = world.transforms[gun].position;
+	float gunRadius = world.colliders[gun].radius;
+	int kinds = 0;
+	int n = markNear(gunPos, gunRadius, TeamBonus, kinds);
+	if (n) {
+		gunLife += 1;
+	}
+	for (int k = 0; k < n; k++) emit(EventBonusPickup, gunPos);
+
+	// missiles hit invaders
+	//
+	for (int i = 0; i < world.size(); i++) {
+		if (world.tags[i].team != TeamMissile) continue;
+		ofVec2f p = world.transforms[i].position;
+		kinds = 0;
+		int n = markNear(p, world.colliders[i].radius, TeamInvader, kinds);
+		if (n) {
+			score += countKinds(kinds);
+			expEmit.setPosition(p);
+			expEmit.start(now);
+		}
+		for (int k = 0; k < n; k++) emit(EventInvaderHit, p);
+	}
+
+	// invaders hit the ship
+	//
+	kinds = 0;
+	n = markNear(gunPos, gunRadius, TeamInvader, kinds);
+	gunLife -= countKinds(kinds);
+	for (int k = 0; k < n; k++) emit(EventInvaderHit, gunPos);
+	world.removeMarked();
+
+#ifdef COLLISION_DIFF_CHECK
+	int nAliens = 0;
+	for (int i = 0; i < world.size(); i++) nAliens += world.tags[i].team == TeamInvader;
+	if (score != expectScore || gunLife != expectLife || nAliens != expectAliens) {
+		ofLogError("checkCollisions") << "grid/brute force mismatch: score " << score << "/" << expectScore
+			<< " lives " << gunLife << "/" << expectLife << " invaders " << nAliens << "/" << expectAliens;
+	}
+#endif
+}
+
+//  Reference O(M x N) version of checkCollisions().  Leaves the world
+//  alone and only reports the resulting score, lives and number of
+//  invaders left, and if asked which entities checkCollisions() should
+//  remove (see CollisionCheck.cpp).
+//
+void GameSim::checkCollisionsBruteForce(int &score, int &gunLife, int &nAliens, vector<char> *removedOut) {
+	int n = world.size();
+	vector<char> removed(n, 0);
+	const ofVec2f &gunPos = world.transforms[gun].position;
+	float gunRadius = world.colliders[gun].radius;
+
+	auto touches = [&](int e, const ofVec2f &p, float radius) {
+		return (world.transforms[e].position - p).length() < radius + world.colliders[e].radius;
+	};
+
+	bool pickup = false;
+	for (int e = 0; e < n; e++) {
+		if (world.tags[e].team == TeamBonus && touches(e, gunPos, gunRadius)) {
+			removed[e] = 1;
+			pickup = true;
+		}
+	}
+	if (pickup) gunLife += 1;
+
+	for (int kind = 0; kind < InvaderKinds; kind++) {
+		for (int m = 0; m < n; m++) {
+			if (world.tags[m].team != TeamMissile) continue;
+			bool hit = false;
+			for (int e = 0; e < n; e++) {
+				if (removed[e] || world.tags[e].team != TeamInvader || world.tags[e].kind != kind) continue;
+				if (touches(e, world.transforms[m].position, world.colliders[m].radius)) {
+					removed[e] = 1;
+					hit = true;
+				}
+			}
+			if (hit) score += 1;
+		}
+		bool hitShip = false;
+		for (int e = 0; e < n; e++) {
+			if (removed[e] || world.tags[e].team != TeamInvader || world.tags[e].kind != kind) continue;
+			if (touches(e, gunPos, gunRadius)) {
+				removed[e] = 1;
+				hitShip = true;
+			}
+		}
+		if (hitShip) gunLife -= 1;
+	}
+
+	for (int e = 0; e < n; e++) {
+		if (world.tags[e].team == TeamInvader && !removed[e]) nAliens++;
+	}
+	if (removedOut) removedOut->swap(removed);
+}
+
+//  Fire button down: the first press starts the game, after that it
+//  starts the gun
+//
+void GameSim::pressFire() {
+	if (!startAnim) {
+		// Record when the game starts
+		startAnim = true;
+		gameStartTime = clock.getNow();
+		for (int i = 0; i < activeInvaders(); i++) {
+			invaders[i].started = true;
+		}
+	}
+	else if (!gameOver) {
+		if (!missiles.started) {
+			missiles.started = true;
+			emit(EventFireStart, world.transforms[gun].position);
+		}
+	}
+}
+
+void GameSim::releaseFire() {
+	missiles.stop();
+	emit(EventFireStop, world.transforms[gun].position);
+}
+
+//  Quit the current game (shows the game over screen)
+//
+void GameSim::endGame() {
+	gameOver = true;
+	missiles.stop();
+	thrusterShip.stop();
+	invading = false;
+	world.killTeam(TeamInvader);
+	world.removeMarked();
+}
+
+//  Drop a bonus pill now
+//
+void GameSim::dropBonus() {
+	bonus.start(clock.getNow());
+	emit(EventBonusDrop, bonus.position);
+}
+
+//  What the game keys, drags and resizes do.  ofApp sends every input
+//  that changes the game through here, so a recording of them replays
+//  the same game.
+//
+void GameSim::input(const InputEvent &e) {
+	switch (e.type) {
+	case InputKeyPressed:
+		switch (e.key) {
+		case OF_KEY_UP:
+			setMoveDir(MoveUp);
+			break;
+		case OF_KEY_DOWN:
+			setMoveDir(MoveDown);
+			break;
+		case OF_KEY_LEFT:
+			setMoveDir(MoveLeft);
+			break;
+		case OF_KEY_RIGHT:
+			setMoveDir(MoveRight);
+			break;
+		case ' ':
+			pressFire();
+			break;
+		case 'x':
+			endGame();
+			break;
+		case 'm':
+			dropBonus();
+			break;
+		}
+		break;
+	case InputKeyReleased:
+		switch (e.key) {
+		case OF_KEY_LEFT:
+		case OF_KEY_RIGHT:
+		case OF_KEY_UP:
+		case OF_KEY_DOWN:
+			setMoveDir(MoveStop);
+			break;
+		case ' ':
+			releaseFire();
+			break;
+		}
+		break;
+	case InputDrag:
+		world.transforms[gun].position += ofVec2f(e.x, e.y);
+		break;
+	case InputTurn:
+		world.transforms[gun].rotation += e.x;
+		break;
+	case InputResize:
+		resize(e.x, e.y);
+		break;
+	}
+}
+
+int GameSim::getSpriteCount() const {
+	return world.size();
+}
+
+int GameSim::getParticleCount() const {
+	return expEmit.sys->particles.size() + expEmitShip.sys->particles.size() + thrusterShip.sys->particles.size();
+}
+
+//  Copy what the renderer needs into "out" (see RenderSnapshot): the
+//  entities of one team, in world order, with their image id and size
+//
+static void addSprites(RenderSnapshot &out, const World &world, Team team) {
+	RenderSnapshot::Quad q;
+	for (int i = 0; i < world.size(); i++) {
+		if (world.tags[i].team != team) continue;
+		const World::Transform &t = world.transforms[i];
+		const World::Sprite &s = world.sprites[i];
+		if (s.width == 0 || s.height == 0) continue;
+		q.image = s.image;
+		q.w = s.width;
+		q.h = s.height;
+		q.x0 = t.lastPosition.x; q.y0 = t.lastPosition.y;
+		q.x1 = t.position.x; q.y1 = t.position.y;
+		q.rot = t.rotation;
+		out.sprites.push_back(q);
+	}
+}
+
+void GameSim::capture(RenderSnapshot &out) const {
+	out.clear();
+	out.tick = clock.getTicks();
+	out.dt = clock.getDt();
+
+	const ParticleEmitter *effects[] = { &expEmit, &expEmitShip, &thrusterShip };
+	for (int i = 0; i < 3; i++) {
+		if (effects[i]->visible) {
+			RenderSnapshot::Marker m = { effects[i]->position, effects[i]->radius / 10 };
+			out.markers.push_back(m);
+		}
+		out.addParticles(*effects[i]->sys, out.dt);
+	}
+
+	out.paths = paths.getTables();
+
+	out.liveSprites = getSpriteCount();
+	out.freeSprites = world.capacity() - world.size();
+	out.refusedSprites = world.refused;
+
+	addSprites(out, world, TeamInvader);
+	if (!gameOver) {
+		addSprites(out, world, TeamPlayer);
+		addSprites(out, world, TeamMissile);
+		addSprites(out, world, TeamBonus);
+	}
+
+	out.score = score;
+	out.gunLife = gunLife;
+	out.level = level;
+	out.playtime = playtime;
+	out.startAnim = startAnim;
+	out.gameOver = gameOver;
+}
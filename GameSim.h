@@ -0,0 +1,198 @@
+#pragma once
+
+#include "ofMain.h"
+#include "World.h"
+#include "SpatialGrid.h"
+#include "PathEngine.h"
+#include "ParticleEmitter.h"
+#include "SimClock.h"
+#include "FastRandom.h"
+#include "RenderSnapshot.h"
+
+typedef enum { MoveStop, MoveLeft, MoveRight, MoveUp, MoveDown } MoveDir;
+
+//  Things that happened during a tick that the front end may want to react
+//  to, e.g. with a sound.  The simulation itself never plays anything.
+//
+typedef enum {
+	EventFireStart,         // gun started firing (the looping missile sound)
+	EventFireStop,
+	EventInvaderHit,        // an invader was hit by a missile or the ship
+	EventBonusPickup,
+	EventBonusDrop,
+	EventLevelUp,
+	EventShipDestroyed
+} GameEventType;
+
+struct GameEvent {
+	GameEventType type;
+	ofVec3f position;
+};
+
+//  One input from the front end that changes the game, in the form
+//  InputRecorder keeps it: a key going down or up (key), a drag of the
+//  ship (x, y pixels), a turn of the ship (x degrees) or a new play
+//  field size (x, y).
+//
+typedef enum { InputKeyPressed, InputKeyReleased, InputDrag, InputTurn, InputResize } InputType;
+
+struct InputEvent {
+	InputType type;
+	int key = 0;
+	int x = 0, y = 0;
+};
+
+//  Puts new entities of one team (and invader kind) into the world at a
+//  fixed rate: the missiles of the gun, each type of invader and the
+//  bonus pills.  Entities of a spawner that is stopped are removed.
+//
+struct Spawner {
+	void start(float now) { started = true; lastSpawned = now; count = 0; }
+	void stop() { started = false; }
+
+	Team team = TeamInvader;
+	int kind = 0;
+	ofVec2f position;
+	glm::vec3 velocity;             // given to the entities, pixels/sec
+	float rate = 1;                 // per sec
+	float lifespan = -1;            // ms
+	bool started = false;
+	float lastSpawned = 0;          // ms
+	int maxCount = -1;              // at most this many per start(), -1 = at "rate"
+	int count = 0;
+	int image = -1;                 // sprite image id (see ImageSource)
+	float width = 10, height = 10;  // size of the entities, they collide as a circle of height / 2
+	int path = -1;                  // GameSim::paths table the entities follow from where they spawn, -1 => none
+};
+
+//  Looks up the id of a sprite image by name, -1 if there is none.  The
+//  simulation only stores the ids (sizes are its own) and the renderer
+//  maps them back to its images, so headless runs don't pass one.
+//
+typedef std::function<int (const string &name)> ImageSource;
+
+//  The game without a window: gun, invaders, bonus, collisions, score and
+//  levels, and the particle effects that go with them.
+//
+//  The ship, missiles, invaders and bonus pills are all entities of one
+//  World, so a single update pass moves and expires them and a single
+//  grid pass finds every collision.
+//
+//  Everything advances in fixed ticks of the sim clock and only depends
+//  on the play field size given to setup() and the input calls below, so
+//  it runs the same on a build box (main.cpp --headless) as inside ofApp,
+//  which just feeds it input, draws it and plays sounds for its events.
+//
+class GameSim {
+public:
+	~GameSim();
+	void setup(float w, float h, ImageSource images = nullptr);
+	void update(float elapsed);     // real seconds, runs as many ticks as due
+	void tick();                    // run exactly one tick
+	void simulate(float dt, float now);
+	void checkCollisions(float now);
+	void checkCollisionsBruteForce(int &score, int &gunLife, int &nAliens, vector<char> *removed = NULL);
+	void followPaths(float dt);
+	void resize(float w, float h);  // new play field, rebakes the paths
+
+	// input
+	//
+	void setMoveDir(MoveDir d) { moveDir = d; }
+	void pressFire();               // first press starts the game
+	void releaseFire();
+	void endGame();
+	void dropBonus();
+	void input(const InputEvent &e);        // a key, drag or resize, see above
+
+	int getSpriteCount() const;
+	int getParticleCount() const;
+	void capture(RenderSnapshot &out) const;    // state for drawing, see SimThread
+
+	// fixed timestep clock; "now" is ticks * dt so it never reads the
+	// wall clock
+	//
+	SimClock clock;
+
+	// game random numbers. Particle systems own their own generators,
+	// all seeded from "usedSeed" in setup() so a run can be reproduced.
+	//
+	FastRandom rng;
+	uint64_t seed = 0;      // requested; 0 = pick a new one from the clock on every setup()
+	uint64_t usedSeed = 0;  // the one the current game runs with
+
+	vector<GameEvent> events;       // since the front end last cleared it
+
+	float width = 0, height = 0;    // play field (the window in ofApp)
+	ofRectangle playarea;
+
+	World world;
+	int gun = 0;                    // the ship, always the first entity
+	Spawner missiles;               // fired by the gun
+	Spawner bonus;                  // bonus pills, a life each
+	enum { InvaderKinds = 5 };
+	Spawner invaders[InvaderKinds];
+	bool invading = false;          // false once the game is over
+	int activeInvaders() const { return invading ? min(level, int(InvaderKinds)) : 0; }
+
+	// invader paths, baked for the play field size and level
+	//
+	enum { PathInvader2, PathInvader3, PathInvader4, PathInvader5, PathCount };
+	PathEngine paths;
+	int pathLevel = -1;             // level the paths were baked for
+
+	// ship motion
+	//
+	glm::vec3 shipAcceleration, shipVerVelocity, shipHorVelocity;
+	float shipSpeed = 0;
+	float shipDamping = 0.99;
+
+	ParticleEmitter expEmit;
+	ParticleEmitter expEmitShip;
+	ParticleEmitter thrusterShip;
+
+	TurbulenceForce *turbForce = NULL;
+	GravityForce *gravityForce = NULL;
+	ImpulseRadialForce *radialForce = NULL;
+
+	int hit;
+	int score = 0;
+	int gunLife = 3;
+	int level = 0;
+	float playtime = 0;
+	float gameStartTime = 0;
+	float currentplaytime = 0;
+	bool gameOver = false;
+	bool startAnim = false;
+	bool levelup = false;
+	MoveDir moveDir = MoveStop;
+	int move = 0;
+
+private:
+	void emit(GameEventType type, const ofVec3f &position);
+	void freeObjects();
+	void updateJob(int i);
+	void updateWorld(float dt, float now);
+	void bakePaths();
+	void spawnFrom(Spawner &s, float dt, float now);
+	Spawner *spawnerOf(int entity);
+	int markNear(const ofVec2f &p, float radius, Team team, int &kinds);
+
+	float stepDt = 0, stepNow = 0;  // arguments of the simulate() in progress
+
+	// collision broadphase over the invaders and bonus pills.  The grid
+	// points keep a copy of what the narrow phase needs so it doesn't
+	// gather from the component arrays.
+	//
+	struct Target {
+		ofVec2f position;
+		float radius;
+		int entity;
+		Team team;
+		int kind;
+	};
+	SpatialGrid grid;
+	vector<Target> targets;         // one per grid point
+	vector<char> targetDead;        // hit this tick, checked before the target is read
+	vector<int> candidates;
+	float maxTargetRadius = 0;
+};
@@ -0,0 +1,60 @@
+#include "ImageHandle.h"
+
+static atomic<int> liveImages(0);
+
+ImageHandle::Asset::Asset() {
+	liveImages++;
+}
+
+ImageHandle::Asset::~Asset() {
+	liveImages--;
+}
+
+ImageHandle::ImageHandle(const ofImage &img) {
+	asset = make_shared<Asset>();
+	asset->image = img;
+}
+
+//  Load an image from disk into a new shared asset. Other handles that
+//  pointed at a previous asset keep it alive.
+//
+bool ImageHandle::load(const string &path) {
+	shared_ptr<Asset> a = make_shared<Asset>();
+	if (!a->image.load(path)) return false;
+	asset = a;
+	return true;
+}
+
+//  Create a new shared asset from already decoded pixels (uploads the
+//  texture, so call it from the main thread).
+//
+void ImageHandle::setFromPixels(const ofPixels &pixels) {
+	asset = make_shared<Asset>();
+	asset->image.setFromPixels(pixels);
+}
+
+//  Resize the shared image in place; all handles see the new size.
+//  Resizing to the current size is a no-op so cached images can be
+//  "resized" again on restart without resampling.
+//
+void ImageHandle::resize(int w, int h) {
+	if (!asset) return;
+	if (asset->image.getWidth() == w && asset->image.getHeight() == h) return;
+	asset->image.resize(w, h);
+}
+
+void ImageHandle::draw(float x, float y) const {
+	if (asset) asset->image.draw(x, y);
+}
+
+float ImageHandle::getWidth() const {
+	return asset ? asset->image.getWidth() : 0;
+}
+
+float ImageHandle::getHeight() const {
+	return asset ? asset->image.getHeight() : 0;
+}
+
+int ImageHandle::getLiveCount() {
+	return liveImages;
+}
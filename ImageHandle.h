@@ -0,0 +1,40 @@
+#pragma once
+#include "ofMain.h"
+
+//  Shared, reference-counted handle to an image and its texture.
+//
+//  Copying a handle only copies a pointer, so every sprite spawned by an
+//  emitter shares the emitter's image instead of owning a copy of the
+//  pixels and re-uploading the texture.  The image is released when the
+//  last handle to it goes away.
+//
+class ImageHandle {
+public:
+	ImageHandle() {}
+	ImageHandle(const ofImage &img);    // makes one shared copy of img
+
+	bool load(const string &path);
+	void setFromPixels(const ofPixels &pixels);
+	void resize(int w, int h);
+	void draw(float x, float y) const;
+	void reset() { asset.reset(); }
+
+	bool isLoaded() const { return asset != nullptr; }
+	float getWidth() const;
+	float getHeight() const;
+	ofImage & getImage() { return asset->image; }
+	const ofImage & getImage() const { return asset->image; }
+
+	// number of distinct images alive across all handles.  This stays
+	// constant no matter how many sprites share them.
+	//
+	static int getLiveCount();
+
+private:
+	struct Asset {
+		Asset();
+		~Asset();
+		ofImage image;
+	};
+	shared_ptr<Asset> asset;
+};
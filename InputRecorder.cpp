@@ -0,0 +1,156 @@
+#include "InputRecorder.h"
+
+static const char recordMagic[4] = { '2', 'D', 'S', 'R' };
+static const int recordVersion = 1;
+
+// unsigned LEB128 varints; signed values are zigzag encoded first so
+// small negative drags stay one byte
+//
+static void putVarint(string &out, uint64_t v) {
+	while (v >= 0x80) {
+		out.push_back(char((v & 0x7f) | 0x80));
+		v >>= 7;
+	}
+	out.push_back(char(v));
+}
+
+static void putSigned(string &out, int64_t v) {
+	putVarint(out, (uint64_t(v) << 1) ^ uint64_t(v >> 63));
+}
+
+static bool getVarint(const string &in, size_t &pos, uint64_t &v) {
+	v = 0;
+	for (int shift = 0; shift < 64 && pos < in.size(); shift += 7) {
+		uint8_t b = in[pos++];
+		v |= uint64_t(b & 0x7f) << shift;
+		if (!(b & 0x80)) return true;
+	}
+	return false;
+}
+
+static bool getSigned(const string &in, size_t &pos, int &v) {
+	uint64_t u;
+	if (!getVarint(in, pos, u)) return false;
+	v = int(int64_t(u >> 1) ^ -int64_t(u & 1));
+	return true;
+}
+
+//  Begin a new recording of a game set up with this seed and play field
+//
+void InputRecorder::start(uint64_t s, float w, float h) {
+	seed = s;
+	width = int(w);
+	height = int(h);
+	ticks = 0;
+	entries.clear();
+	recording = true;
+}
+
+void InputRecorder::record(uint64_t tick, const InputEvent &e) {
+	if (!recording) return;
+	Entry entry = { tick, e };
+	entries.push_back(entry);
+}
+
+void InputRecorder::finish(uint64_t tick) {
+	ticks = tick;
+	recording = false;
+}
+
+bool InputRecorder::save(const string &path) const {
+	string out(recordMagic, sizeof(recordMagic));
+	putVarint(out, recordVersion);
+	putVarint(out, seed);
+	putVarint(out, width);
+	putVarint(out, height);
+	putVarint(out, ticks);
+	putVarint(out, entries.size());
+	uint64_t last = 0;
+	for (int i = 0; i < entries.size(); i++) {
+		const Entry &e = entries[i];
+		putVarint(out, e.tick - last);
+		last = e.tick;
+		putVarint(out, e.input.type);
+		switch (e.input.type) {
+		case InputKeyPressed:
+		case InputKeyReleased:
+			putVarint(out, e.input.key);
+			break;
+		case InputTurn:
+			putSigned(out, e.input.x);
+			break;
+		default:
+			putSigned(out, e.input.x);
+			putSigned(out, e.input.y);
+			break;
+		}
+	}
+
+	ofstream file(path.c_str(), ios::binary);
+	file.write(out.data(), out.size());
+	if (!file) {
+		ofLogError("InputRecorder") << "can't write " << path;
+		return false;
+	}
+	return true;
+}
+
+bool InputRecorder::load(const string &path) {
+	ifstream file(path.c_str(), ios::binary);
+	if (!file) {
+		ofLogError("InputRecorder") << "can't read " << path;
+		return false;
+	}
+	string in((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	size_t pos = sizeof(recordMagic);
+	uint64_t version = 0, w = 0, h = 0, count = 0;
+	if (in.compare(0, pos, recordMagic, sizeof(recordMagic)) != 0 || !getVarint(in, pos, version) ||
+		version != recordVersion) {
+		ofLogError("InputRecorder") << path << " is not a version " << recordVersion << " recording";
+		return false;
+	}
+	uint64_t s = 0, n = 0;
+	bool ok = getVarint(in, pos, s) && getVarint(in, pos, w) && getVarint(in, pos, h) &&
+		getVarint(in, pos, n) && getVarint(in, pos, count);
+	if (!ok) {
+		ofLogError("InputRecorder") << path << " is truncated or corrupt";
+		return false;
+	}
+	seed = s;
+	width = int(w);
+	height = int(h);
+	ticks = n;
+
+	entries.clear();
+	uint64_t tick = 0;
+	for (uint64_t i = 0; ok && i < count; i++) {
+		uint64_t delta = 0, type = 0, key = 0;
+		Entry e;
+		ok = getVarint(in, pos, delta) && getVarint(in, pos, type) && type <= InputResize;
+		if (!ok) break;
+		tick += delta;
+		e.tick = tick;
+		e.input.type = InputType(type);
+		switch (e.input.type) {
+		case InputKeyPressed:
+		case InputKeyReleased:
+			ok = getVarint(in, pos, key);
+			e.input.key = int(key);
+			break;
+		case InputTurn:
+			ok = getSigned(in, pos, e.input.x);
+			break;
+		default:
+			ok = getSigned(in, pos, e.input.x) && getSigned(in, pos, e.input.y);
+			break;
+		}
+		if (ok) entries.push_back(e);
+	}
+	if (!ok) {
+		ofLogError("InputRecorder") << path << " is truncated or corrupt";
+		return false;
+	}
+	recording = false;
+	return true;
+}
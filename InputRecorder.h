@@ -0,0 +1,33 @@
+#pragma once
+#include "ofMain.h"
+#include "GameSim.h"
+
+//  A recorded game: the seed and play field GameSim::setup() got, then
+//  every GameSim::input() with the tick it was applied before.  The
+//  simulation only depends on these, so replaying them on a fresh
+//  GameSim (main.cpp --replay) gives the same game tick for tick, at
+//  full speed and without a window.
+//
+//  The file is small and binary: a header, then per input the ticks
+//  since the previous one, the type and its values, all as varints.
+//
+class InputRecorder {
+public:
+	struct Entry {
+		uint64_t tick;          // applied before this tick ran
+		InputEvent input;
+	};
+
+	void start(uint64_t seed, float width, float height);
+	void record(uint64_t tick, const InputEvent &e);
+	void finish(uint64_t tick);     // the game ran "tick" ticks
+	bool save(const string &path) const;
+	bool load(const string &path);
+
+	bool recording = false;
+
+	uint64_t seed = 0;
+	int width = 0, height = 0;
+	uint64_t ticks = 0;             // length of the game
+	vector<Entry> entries;          // in tick order
+};
@@ -0,0 +1,218 @@
+#include "JobSystem.h"
+#include <chrono>
+
+JobSystem jobSystem;
+
+static thread_local int currentSlot = 0;      // 0 unless this is a worker
+
+//  Time this thread spent in wait() or in nested jobs, which the job
+//  around them must not count as its own: busyNanos is leaf time only,
+//  so utilization stays <= 100% when jobs wait on other jobs.
+//
+static thread_local uint64_t excludedNanos = 0;
+
+static uint64_t nowNanos() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+JobSystem::~JobSystem() {
+	stop();
+}
+
+//  Use n threads in total: n - 1 workers plus whoever submits.  Only
+//  call it while no jobs are running; the workers are restarted.
+//
+void JobSystem::setThreads(int n) {
+	std::lock_guard<std::mutex> guard(startLock);
+	stop();
+	threads = n;
+}
+
+int JobSystem::getThreads() {
+	start();
+	return int(workers.size()) + 1;
+}
+
+void JobSystem::start() {
+	if (started) return;
+	std::lock_guard<std::mutex> guard(startLock);
+	if (started) return;
+	int n = threads > 0 ? threads : max(1, int(std::thread::hardware_concurrency()));
+	slots.clear();
+	for (int i = 0; i < n; i++) {
+		slots.push_back(unique_ptr<Slot>(new Slot()));
+		slots.back()->ring.resize(QueueSize);
+	}
+	resetStats();
+	quit = false;
+	for (int i = 1; i < n; i++) workers.push_back(std::thread(&JobSystem::workerLoop, this, i));
+	started = true;
+}
+
+void JobSystem::stop() {
+	{
+		std::lock_guard<std::mutex> guard(sleepLock);
+		quit = true;
+	}
+	wake.notify_all();
+	for (int i = 0; i < workers.size(); i++) workers[i].join();
+	workers.clear();
+	started = false;
+}
+
+//  Run "job" as part of "group" on whichever thread gets to it first
+//
+void JobSystem::run(JobGroup &group, const function<void()> &job) {
+	start();
+	Job j;
+	j.fn = job;
+	j.group = &group;
+	group.pending++;
+	submit(j);
+}
+
+//  Run jobs (any jobs) until every job of "group" is done
+//
+void JobSystem::wait(JobGroup &group) {
+	uint64_t excluded = excludedNanos;
+	uint64_t start = nowNanos();
+	Job job;
+	while (!group.done()) {
+		if (take(currentSlot, job)) execute(currentSlot, job);
+		else std::this_thread::yield();
+	}
+	excludedNanos = excluded + (nowNanos() - start);
+}
+
+//  body(0) ... body(count - 1), one job each, spread over all threads.
+//  Returns when they are all done.
+//
+void JobSystem::parallelFor(int count, const function<void(int)> &body) {
+	if (count <= 0) return;
+	start();
+	if (count == 1 || workers.empty()) {
+		Slot &s = *slots[currentSlot];
+		uint64_t excluded = excludedNanos;
+		uint64_t start = nowNanos();
+		for (int i = 0; i < count; i++) body(i);
+		uint64_t elapsed = nowNanos() - start;
+		s.busyNanos += elapsed - (excludedNanos - excluded);
+		excludedNanos = excluded + elapsed;
+		s.jobs += count;
+		return;
+	}
+
+	JobGroup group;
+	group.pending += count - 1;
+	for (int i = 1; i < count; i++) {
+		Job j;
+		j.body = &body;
+		j.index = i;
+		j.group = &group;
+		submit(j);
+	}
+	body(0);
+	wait(group);
+}
+
+//  Push onto the queue of the calling thread, or run it here if full
+//
+void JobSystem::submit(Job &job) {
+	Slot &s = *slots[currentSlot];
+	bool queuedJob = false;
+	{
+		std::lock_guard<std::mutex> guard(s.lock);
+		if (s.count < QueueSize) {
+			s.ring[(s.head + s.count) % QueueSize] = std::move(job);
+			s.count++;
+			queuedJob = true;
+		}
+	}
+	if (!queuedJob) {
+		execute(currentSlot, job);
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> guard(sleepLock);
+		queued++;
+	}
+	wake.notify_one();
+}
+
+//  Newest job of our own queue, else the oldest job of another queue
+//
+bool JobSystem::take(int slot, Job &job) {
+	if (queued == 0) return false;
+	int n = int(slots.size());
+	for (int k = 0; k < n; k++) {
+		Slot &s = *slots[(slot + k) % n];
+		std::lock_guard<std::mutex> guard(s.lock);
+		if (s.count == 0) continue;
+		if (k == 0) {
+			job = std::move(s.ring[(s.head + s.count - 1) % QueueSize]);
+		}
+		else {
+			job = std::move(s.ring[s.head]);
+			s.head = (s.head + 1) % QueueSize;
+			slots[slot]->steals++;
+		}
+		s.count--;
+		queued--;
+		return true;
+	}
+	return false;
+}
+
+void JobSystem::execute(int slot, Job &job) {
+	uint64_t excluded = excludedNanos;
+	uint64_t start = nowNanos();
+	if (job.body) (*job.body)(job.index);
+	else job.fn();
+	uint64_t elapsed = nowNanos() - start;
+	Slot &s = *slots[slot];
+	s.busyNanos += elapsed - (excludedNanos - excluded);
+	excludedNanos = excluded + elapsed;
+	s.jobs++;
+	JobGroup *group = job.group;
+	job.fn = nullptr;
+	job.body = NULL;
+	job.group = NULL;
+	group->pending--;               // last, the group may be gone after this
+}
+
+void JobSystem::workerLoop(int slot) {
+	currentSlot = slot;
+	Job job;
+	for (;;) {
+		if (take(slot, job)) {
+			execute(slot, job);
+			continue;
+		}
+		std::unique_lock<std::mutex> guard(sleepLock);
+		wake.wait(guard, [this]() { return quit || queued > 0; });
+		if (quit) return;
+	}
+}
+
+vector<JobSystem::WorkerStats> JobSystem::getStats() {
+	start();
+	float elapsed = float(nowNanos() - statsStart);
+	vector<WorkerStats> stats(slots.size());
+	for (int i = 0; i < slots.size(); i++) {
+		stats[i].busyNanos = slots[i]->busyNanos;
+		stats[i].jobs = slots[i]->jobs;
+		stats[i].steals = slots[i]->steals;
+		stats[i].utilization = elapsed > 0 ? stats[i].busyNanos / elapsed : 0;
+	}
+	return stats;
+}
+
+void JobSystem::resetStats() {
+	for (int i = 0; i < slots.size(); i++) {
+		slots[i]->busyNanos = 0;
+		slots[i]->jobs = 0;
+		slots[i]->steals = 0;
+	}
+	statsStart = nowNanos();
+}
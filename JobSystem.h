@@ -0,0 +1,88 @@
+#pragma once
+#include "ofMain.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+//  Jobs submitted together; wait() on it returns when all of them ran.
+//
+class JobGroup {
+public:
+	JobGroup() : pending(0) {}
+	bool done() const { return pending == 0; }
+	atomic<int> pending;
+};
+
+//  Work stealing job scheduler.
+//
+//  Every worker thread has its own queue.  A worker takes its newest job
+//  first (the one whose data is most likely still in cache) and, when its
+//  queue is empty, steals the oldest job of another queue.  Threads that
+//  aren't workers (the app, the benchmark) share slot 0; they run jobs
+//  too while they wait() for a group, so nested groups (a job that runs
+//  a parallelFor) can't deadlock.
+//
+//  Queues are fixed size rings, so submitting a job doesn't allocate
+//  beyond what the std::function itself needs (parallelFor doesn't need
+//  any).  A job that doesn't fit runs right away on the submitting thread.
+//
+class JobSystem {
+public:
+	struct WorkerStats {
+		uint64_t busyNanos = 0;     // time spent running jobs, not counting wait()
+		int jobs = 0;
+		int steals = 0;             // jobs taken from another queue
+		float utilization = 0;      // busy fraction since resetStats()
+	};
+
+	JobSystem() : started(false), queued(0) {}
+	~JobSystem();
+	void setThreads(int n);         // threads including the callers, 0 = one per core
+	int getThreads();
+	void run(JobGroup &group, const function<void()> &job);
+	void wait(JobGroup &group);
+	void parallelFor(int count, const function<void(int)> &body);
+
+	// per slot counters: [0] is the non-worker threads, [1..] the workers
+	//
+	vector<WorkerStats> getStats();
+	void resetStats();
+
+private:
+	enum { QueueSize = 1024 };
+	struct Job {
+		function<void()> fn;
+		const function<void(int)> *body = NULL;     // parallelFor item instead of fn
+		int index = 0;
+		JobGroup *group = NULL;
+	};
+	struct Slot {
+		Slot() : busyNanos(0), jobs(0), steals(0) {}
+		std::mutex lock;
+		vector<Job> ring;
+		int head = 0, count = 0;
+		atomic<uint64_t> busyNanos;
+		atomic<int> jobs, steals;
+	};
+
+	void start();
+	void stop();
+	void submit(Job &job);
+	bool take(int slot, Job &job);
+	void execute(int slot, Job &job);
+	void workerLoop(int slot);
+
+	vector<unique_ptr<Slot> > slots;
+	vector<std::thread> workers;
+	int threads = 0;                // requested, 0 = one per core
+	atomic<bool> started;
+	std::mutex startLock;
+
+	std::mutex sleepLock;           // idle workers sleep until "queued" > 0
+	std::condition_variable wake;
+	atomic<int> queued;
+	bool quit = false;
+	uint64_t statsStart = 0;
+};
+
+extern JobSystem jobSystem;
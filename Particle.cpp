@@ -18,25 +18,11 @@ Particle::Particle() {
 	color = ofColor::white;
 }
 
-void Particle::draw() {
-	ofSetColor(color);
-	//ofSetColor(ofMap(age(), 0, lifespan, 255, 10), 0, 0);
-	ofDrawSphere(position, radius);
-}
-
 // write your own integrator here.. (hint: it's only 3 lines of code)
 //
-void Particle::integrate() {
-
-	// check for 0 framerate to avoid divide errors
-	//
-	float framerate = ofGetFrameRate();
-	if (framerate < 1.0) return;
-
-	// interval for this step
-	//
-	float dt = 1.0 / framerate;
-
+//  dt is the fixed simulation step in seconds
+//
+void Particle::integrate(float dt) {
 
 	// update position based on velocity
 	//
@@ -58,10 +44,10 @@ void Particle::integrate() {
 	forces.set(0, 0, 0);
 }
 
-//  return age in seconds
+//  return age in seconds at simulation time "now" (ms)
 //
-float Particle::age() {
-	return (ofGetElapsedTimeMillis() - birthtime)/1000.0;
+float Particle::age(float now) {
+	return (now - birthtime)/1000.0;
 }
 
 
@@ -17,9 +17,8 @@ public:
 	float   lifespan;
 	float   radius;
 	float   birthtime;
-	void    integrate();
-	void    draw();
-	float   age();        // sec
+	void    integrate(float dt);
+	float   age(float now);   // sec, now in ms
 	ofColor color;
 };
 
@@ -46,34 +46,20 @@ void ParticleEmitter::init() {
 
 
 
-void ParticleEmitter::draw() {
-	if (visible) {
-		switch (type) {
-		case DirectionalEmitter:
-			ofDrawSphere(position, radius/10);  // just draw a small sphere for point emitters 
-			break;
-		case SphereEmitter:
-		case RadialEmitter:
-			ofDrawSphere(position, radius/10);  // just draw a small sphere as a placeholder
-			break;
-		default:
-			break;
-		}
-	}
-	sys->draw();  
-}
-void ParticleEmitter::start() {
+void ParticleEmitter::start(float now) {
 	started = true;
-	lastSpawned = ofGetElapsedTimeMillis();
+	lastSpawned = now;
 }
 
 void ParticleEmitter::stop() {
 	started = false;
 	fired = false;
 }
-void ParticleEmitter::update() {
+//  dt is the simulation step in seconds, now the simulation time in ms
+//
+void ParticleEmitter::update(float dt, float now) {
 
-	float time = ofGetElapsedTimeMillis();
+	float time = now;
 
 	if (oneShot && started) {
 		if (!fired) {
@@ -99,7 +85,7 @@ void ParticleEmitter::update() {
 		lastSpawned = time;
 	}
 
-	sys->update();
+	sys->update(dt, now);
 }
 
 // spawn a single particle.  time is current time of birth
@@ -114,7 +100,8 @@ void ParticleEmitter::spawn(float time) {
 	switch (type) {
 	case RadialEmitter:
 	{
-		ofVec3f dir = ofVec3f(ofRandom(-1, 1), ofRandom(-1, 1), ofRandom(-1, 1));
+		FastRandom &rng = sys->rng;
+		ofVec3f dir = ofVec3f(rng.uniform(-1, 1), rng.uniform(-1, 1), rng.uniform(-1, 1));
 		float speed = velocity.length();
 		particle.velocity = dir.getNormalized() * speed;
 		particle.position.set(position);
@@ -128,7 +115,8 @@ void ParticleEmitter::spawn(float time) {
 		break;
 	case DiscEmitter:   // x-z plane
 	{
-		ofVec3f dir = ofVec3f(ofRandom(-1, 1), ofRandom(-.2, .2), ofRandom(-1, 1));
+		FastRandom &rng = sys->rng;
+		ofVec3f dir = ofVec3f(rng.uniform(-1, 1), rng.uniform(-.2, .2), rng.uniform(-1, 1));
 		//	dir.y = 0; 
 		particle.position.set(position + (dir.normalized() * radius));
 		particle.velocity = velocity;
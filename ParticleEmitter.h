@@ -16,8 +16,7 @@ public:
 	ParticleEmitter(ParticleSystem *s);
 	~ParticleEmitter();
 	void init();
-	void draw();
-	void start();
+	void start(float now);
 	void stop();
 	void setLifespan(const float life)   { lifespan = life; }
 	void setVelocity(const ofVec3f &vel) { velocity = vel; }
@@ -26,7 +25,7 @@ public:
 	void setEmitterType(EmitterType t) { type = t; }
 	void setGroupSize(int s) { groupSize = s; }
 	void setOneShot(bool s) { oneShot = s; }
-	void update();
+	void update(float dt, float now);
 	void spawn(float time);
 	ParticleSystem *sys;
 	float rate;         // per sec
@@ -0,0 +1,135 @@
+#include "ParticleIndex.h"
+
+static const int maxCell = 0xffff;
+
+//  Spread the low 16 bits of v out to the even bits
+//
+static uint32_t spreadBits(uint32_t v) {
+	v &= 0x0000ffff;
+	v = (v | (v << 8)) & 0x00ff00ff;
+	v = (v | (v << 4)) & 0x0f0f0f0f;
+	v = (v | (v << 2)) & 0x33333333;
+	v = (v | (v << 1)) & 0x55555555;
+	return v;
+}
+
+uint32_t ParticleIndex::morton(uint32_t x, uint32_t y) {
+	return spreadBits(x) | (spreadBits(y) << 1);
+}
+
+int ParticleIndex::cellX(float x) const {
+	return ofClamp(floor((x - originX) / cellSize), 0, maxCell);
+}
+
+int ParticleIndex::cellY(float y) const {
+	return ofClamp(floor((y - originY) / cellSize), 0, maxCell);
+}
+
+void ParticleIndex::build(const ParticleStore &store, float size) {
+	cellSize = size;
+	int n = store.size();
+	keys.resize(n);
+	ids.resize(n);
+	if (n == 0) return;
+
+	// grid origin at the minimum corner so every cell index is >= 0
+	//
+	originX = *std::min_element(store.px.begin(), store.px.end());
+	originY = *std::min_element(store.py.begin(), store.py.end());
+
+	for (int i = 0; i < n; i++) {
+		keys[i] = morton(cellX(store.px[i]), cellY(store.py[i]));
+		ids[i] = i;
+	}
+
+	// LSD radix sort, 8 bits per pass. Passes where every key has the same
+	// digit are skipped (common when particles cover a small area).
+	//
+	tmpKeys.resize(n);
+	tmpIds.resize(n);
+	for (int shift = 0; shift < 32; shift += 8) {
+		int count[257] = { 0 };
+		for (int i = 0; i < n; i++) count[((keys[i] >> shift) & 0xff) + 1]++;
+		if (count[((keys[0] >> shift) & 0xff) + 1] == n) continue;
+		for (int d = 0; d < 256; d++) count[d + 1] += count[d];
+		for (int i = 0; i < n; i++) {
+			int dst = count[(keys[i] >> shift) & 0xff]++;
+			tmpKeys[dst] = keys[i];
+			tmpIds[dst] = ids[i];
+		}
+		keys.swap(tmpKeys);
+		ids.swap(tmpIds);
+	}
+}
+
+//  Append the ids of all particles whose cell lies in [x0,x1] x [y0,y1].
+//  Small ranges look up each cell with a binary search; large ones scan
+//  the Morton range between the two corners and filter by cell.
+//
+void ParticleIndex::collectCells(int x0, int y0, int x1, int y1, vector<int> &out) const {
+	// cells go up to 0xffff, so the count can reach 2^32
+	int64_t nCells = int64_t(x1 - x0 + 1) * (y1 - y0 + 1);
+	if (nCells <= 64) {
+		for (int y = y0; y <= y1; y++) {
+			for (int x = x0; x <= x1; x++) {
+				uint32_t code = morton(x, y);
+				vector<uint32_t>::const_iterator lo = std::lower_bound(keys.begin(), keys.end(), code);
+				for (; lo != keys.end() && *lo == code; lo++) {
+					out.push_back(ids[lo - keys.begin()]);
+				}
+			}
+		}
+		return;
+	}
+
+	uint32_t loCode = morton(x0, y0);
+	uint32_t hiCode = morton(x1, y1);
+	vector<uint32_t>::const_iterator lo = std::lower_bound(keys.begin(), keys.end(), loCode);
+	vector<uint32_t>::const_iterator hi = std::upper_bound(lo, keys.end(), hiCode);
+	uint32_t xMin = spreadBits(x0), xMax = spreadBits(x1);
+	uint32_t yMin = spreadBits(y0) << 1, yMax = spreadBits(y1) << 1;
+	for (; lo != hi; lo++) {
+		uint32_t x = *lo & 0x55555555;
+		uint32_t y = *lo & 0xaaaaaaaa;
+		if (x >= xMin && x <= xMax && y >= yMin && y <= yMax) {
+			out.push_back(ids[lo - keys.begin()]);
+		}
+	}
+}
+
+//  Append the ids of all particles within r of p (full 3D distance)
+//
+void ParticleIndex::queryRadius(const ParticleStore &store, const ofVec3f &p, float r, vector<int> &out) const {
+	if (ids.empty()) return;
+	size_t first = out.size();
+	collectCells(cellX(p.x - r), cellY(p.y - r), cellX(p.x + r), cellY(p.y + r), out);
+
+	// exact test, compacting the candidates in place
+	//
+	float r2 = r * r;
+	size_t w = first;
+	for (size_t k = first; k < out.size(); k++) {
+		int i = out[k];
+		float dx = store.px[i] - p.x, dy = store.py[i] - p.y, dz = store.pz[i] - p.z;
+		if (dx * dx + dy * dy + dz * dz < r2) out[w++] = i;
+	}
+	out.resize(w);
+}
+
+//  Append the ids of all particles whose x/y lies inside rect
+//
+void ParticleIndex::queryRect(const ParticleStore &store, const ofRectangle &rect, vector<int> &out) const {
+	if (ids.empty()) return;
+	size_t first = out.size();
+	collectCells(cellX(rect.getLeft()), cellY(rect.getTop()), cellX(rect.getRight()), cellY(rect.getBottom()), out);
+
+	size_t w = first;
+	for (size_t k = first; k < out.size(); k++) {
+		int i = out[k];
+		if (store.px[i] >= rect.getLeft() && store.px[i] <= rect.getRight() &&
+			store.py[i] >= rect.getTop() && store.py[i] <= rect.getBottom()) {
+			out[w++] = i;
+		}
+	}
+	out.resize(w);
+}
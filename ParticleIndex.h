@@ -0,0 +1,35 @@
+#pragma once
+#include "ofMain.h"
+#include "ParticleStore.h"
+
+//  Spatial index over a ParticleStore, sorted along a Z-order (Morton)
+//  curve.
+//
+//  build() quantizes each particle's x/y into a grid cell, interleaves
+//  the cell coordinates into a 32 bit Morton code and radix sorts the
+//  particle ids by code, so nearby particles end up next to each other.
+//  Queries look up the cells they overlap and only test the particles in
+//  them.  Rebuilding is O(n) and reuses its buffers, so it is cheap to
+//  do once per tick.
+//
+class ParticleIndex {
+public:
+	void build(const ParticleStore &store, float cellSize);
+	void queryRadius(const ParticleStore &store, const ofVec3f &p, float r, vector<int> &out) const;
+	void queryRect(const ParticleStore &store, const ofRectangle &rect, vector<int> &out) const;
+	int size() const { return int(ids.size()); }
+
+	static uint32_t morton(uint32_t x, uint32_t y);
+
+private:
+	int cellX(float x) const;
+	int cellY(float y) const;
+	void collectCells(int x0, int y0, int x1, int y1, vector<int> &out) const;
+
+	float cellSize = 32;
+	float originX = 0, originY = 0;
+	vector<uint32_t> keys;      // sorted Morton codes
+	vector<int> ids;            // particle id for each key
+	vector<uint32_t> tmpKeys;   // radix sort buffers
+	vector<int> tmpIds;
+};
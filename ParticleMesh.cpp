@@ -0,0 +1,60 @@
+#include "ParticleMesh.h"
+#include "RenderStats.h"
+
+void ParticleMesh::begin(int n) {
+	if (indexCount == 0) {
+		mesh.setMode(OF_PRIMITIVE_TRIANGLES);
+		mesh.setUsage(GL_STREAM_DRAW);
+	}
+	mesh.getVertices().resize(n * 4);
+	mesh.getColors().resize(n * 4);
+	verts = mesh.getVertices().data();
+	colors = mesh.getColors().data();
+	count = n;
+}
+
+void ParticleMesh::end() {
+	int n = count;
+	if (n == 0) return;
+
+	// two triangles per quad; only extend the pattern when we need more
+	//
+	vector<ofIndexType> &indices = mesh.getIndices();
+	if (indexCount < n) {
+		indices.resize(n * 6);
+		for (int i = indexCount; i < n; i++) {
+			ofIndexType v = i * 4;
+			indices[i * 6 + 0] = v;
+			indices[i * 6 + 1] = v + 1;
+			indices[i * 6 + 2] = v + 2;
+			indices[i * 6 + 3] = v;
+			indices[i * 6 + 4] = v + 2;
+			indices[i * 6 + 5] = v + 3;
+		}
+		indexCount = n;
+	}
+	indices.resize(n * 6);
+	if (indexCount > n) indexCount = n;
+
+	ofSetColor(ofColor::white);
+	mesh.draw();
+	renderStats.drawCalls++;
+	renderStats.quads += n;
+}
+
+//  The emitters of "snap" as small spheres, then all of its particles,
+//  "alpha" of the way from their previous position
+//
+void ParticleMesh::draw(const RenderSnapshot &snap, float alpha) {
+	for (int i = 0; i < snap.markers.size(); i++) {
+		ofDrawSphere(snap.markers[i].position, snap.markers[i].radius);
+	}
+	int n = int(snap.px1.size());
+	if (n == 0) return;
+	begin(n);
+	for (int i = 0; i < n; i++) {
+		set(i, snap.px0[i] + (snap.px1[i] - snap.px0[i]) * alpha, snap.py0[i] + (snap.py1[i] - snap.py0[i]) * alpha,
+			snap.pz[i], snap.radius[i], snap.color[i]);
+	}
+	end();
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include "ofMain.h"
+#include "RenderSnapshot.h"
+
+//  Particle cloud as screen aligned quads (2 triangles each) in one
+//  vertex buffer that is rewritten in place and drawn with a single call.
+//  begin(n), set() each particle, end().  The vectors keep their
+//  capacity, so a steady particle count doesn't allocate, and the index
+//  pattern only grows when the count does.  Plain VBO + colors, so it
+//  also runs on software GL.
+//
+//  Drawing code only: the simulation hands its particles over in a
+//  RenderSnapshot and never touches a mesh.
+//
+class ParticleMesh {
+public:
+	void begin(int n);
+	void set(int i, float x, float y, float z, float r, const ofColor &color) {
+		glm::vec3 *v = &verts[i * 4];
+		v[0] = glm::vec3(x - r, y - r, z);
+		v[1] = glm::vec3(x + r, y - r, z);
+		v[2] = glm::vec3(x + r, y + r, z);
+		v[3] = glm::vec3(x - r, y + r, z);
+		ofFloatColor c = color;
+		ofFloatColor *cs = &colors[i * 4];
+		cs[0] = c;
+		cs[1] = c;
+		cs[2] = c;
+		cs[3] = c;
+	}
+	void end();
+	void draw(const RenderSnapshot &snap, float alpha);     // its emitters and particles
+private:
+	ofVboMesh mesh;
+	glm::vec3 *verts = NULL;
+	ofFloatColor *colors = NULL;
+	int count = 0;
+	int indexCount = 0;             // quads the index buffer is set up for
+};
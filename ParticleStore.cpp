@@ -0,0 +1,208 @@
+#include "ParticleStore.h"
+#include "CompactArray.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define PARTICLE_SIMD_WIDTH 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PARTICLE_SIMD_WIDTH 4
+#else
+#define PARTICLE_SIMD_WIDTH 1
+#endif
+
+atomic<int> alignedAllocCount(0);
+
+void ParticleStore::reserve(int n) {
+	px.reserve(n); py.reserve(n); pz.reserve(n);
+	vx.reserve(n); vy.reserve(n); vz.reserve(n);
+	ax.reserve(n); ay.reserve(n); az.reserve(n);
+	fx.reserve(n); fy.reserve(n); fz.reserve(n);
+	mass.reserve(n);
+	damping.reserve(n);
+	lifespan.reserve(n);
+	birthtime.reserve(n);
+	radius.reserve(n);
+	color.reserve(n);
+}
+
+void ParticleStore::add(const Particle &p) {
+	px.push_back(p.position.x); py.push_back(p.position.y); pz.push_back(p.position.z);
+	vx.push_back(p.velocity.x); vy.push_back(p.velocity.y); vz.push_back(p.velocity.z);
+	ax.push_back(p.acceleration.x); ay.push_back(p.acceleration.y); az.push_back(p.acceleration.z);
+	fx.push_back(p.forces.x); fy.push_back(p.forces.y); fz.push_back(p.forces.z);
+	mass.push_back(p.mass);
+	damping.push_back(p.damping);
+	lifespan.push_back(p.lifespan);
+	birthtime.push_back(p.birthtime);
+	radius.push_back(p.radius);
+	color.push_back(p.color);
+}
+
+//  Gather particle i back into a Particle value
+//
+Particle ParticleStore::get(int i) const {
+	Particle p;
+	p.position.set(px[i], py[i], pz[i]);
+	p.velocity.set(vx[i], vy[i], vz[i]);
+	p.acceleration.set(ax[i], ay[i], az[i]);
+	p.forces.set(fx[i], fy[i], fz[i]);
+	p.mass = mass[i];
+	p.damping = damping[i];
+	p.lifespan = lifespan[i];
+	p.birthtime = birthtime[i];
+	p.radius = radius[i];
+	p.color = color[i];
+	return p;
+}
+
+//  Scatter a Particle value into slot i
+//
+void ParticleStore::set(int i, const Particle &p) {
+	px[i] = p.position.x; py[i] = p.position.y; pz[i] = p.position.z;
+	vx[i] = p.velocity.x; vy[i] = p.velocity.y; vz[i] = p.velocity.z;
+	ax[i] = p.acceleration.x; ay[i] = p.acceleration.y; az[i] = p.acceleration.z;
+	fx[i] = p.forces.x; fy[i] = p.forces.y; fz[i] = p.forces.z;
+	mass[i] = p.mass;
+	damping[i] = p.damping;
+	lifespan[i] = p.lifespan;
+	birthtime[i] = p.birthtime;
+	radius[i] = p.radius;
+	color[i] = p.color;
+}
+
+void ParticleStore::remove(int i) {
+	px.erase(px.begin() + i); py.erase(py.begin() + i); pz.erase(pz.begin() + i);
+	vx.erase(vx.begin() + i); vy.erase(vy.begin() + i); vz.erase(vz.begin() + i);
+	ax.erase(ax.begin() + i); ay.erase(ay.begin() + i); az.erase(az.begin() + i);
+	fx.erase(fx.begin() + i); fy.erase(fy.begin() + i); fz.erase(fz.begin() + i);
+	mass.erase(mass.begin() + i);
+	damping.erase(damping.begin() + i);
+	lifespan.erase(lifespan.begin() + i);
+	birthtime.erase(birthtime.begin() + i);
+	radius.erase(radius.begin() + i);
+	color.erase(color.begin() + i);
+}
+
+//  Remove every particle i with dead[i] set in a single pass over each
+//  array, keeping the survivors in order.  Returns the number removed.
+//
+int ParticleStore::compact(const vector<char> &dead) {
+	int n = size();
+	compactArray(px, dead); compactArray(py, dead); compactArray(pz, dead);
+	compactArray(vx, dead); compactArray(vy, dead); compactArray(vz, dead);
+	compactArray(ax, dead); compactArray(ay, dead); compactArray(az, dead);
+	compactArray(fx, dead); compactArray(fy, dead); compactArray(fz, dead);
+	compactArray(mass, dead);
+	compactArray(damping, dead);
+	compactArray(lifespan, dead);
+	compactArray(birthtime, dead);
+	compactArray(radius, dead);
+	compactArray(color, dead);
+	return n - size();
+}
+
+template <class Array>
+static void rotateArray(Array &a, int first) {
+	std::rotate(a.begin(), a.begin() + first, a.end());
+}
+
+void ParticleStore::rotate(int first) {
+	rotateArray(px, first); rotateArray(py, first); rotateArray(pz, first);
+	rotateArray(vx, first); rotateArray(vy, first); rotateArray(vz, first);
+	rotateArray(ax, first); rotateArray(ay, first); rotateArray(az, first);
+	rotateArray(fx, first); rotateArray(fy, first); rotateArray(fz, first);
+	rotateArray(mass, first);
+	rotateArray(damping, first);
+	rotateArray(lifespan, first);
+	rotateArray(birthtime, first);
+	rotateArray(radius, first);
+	rotateArray(color, first);
+}
+
+void ParticleStore::clear() {
+	px.clear(); py.clear(); pz.clear();
+	vx.clear(); vy.clear(); vz.clear();
+	ax.clear(); ay.clear(); az.clear();
+	fx.clear(); fy.clear(); fz.clear();
+	mass.clear();
+	damping.clear();
+	lifespan.clear();
+	birthtime.clear();
+	radius.clear();
+	color.clear();
+}
+
+//  Same integrator as Particle::integrate(), one component array at a time:
+//
+//     p += v * dt
+//     v += (a + f / m) * dt
+//     v *= damping
+//     f = 0
+//
+void ParticleStore::integrateScalar(int begin, int end, float dt) {
+	for (int i = begin; i < end; i++) {
+		float invMass = 1.0f / mass[i];
+		px[i] += vx[i] * dt;
+		py[i] += vy[i] * dt;
+		pz[i] += vz[i] * dt;
+		vx[i] = (vx[i] + (ax[i] + fx[i] * invMass) * dt) * damping[i];
+		vy[i] = (vy[i] + (ay[i] + fy[i] * invMass) * dt) * damping[i];
+		vz[i] = (vz[i] + (az[i] + fz[i] * invMass) * dt) * damping[i];
+		fx[i] = 0;
+		fy[i] = 0;
+		fz[i] = 0;
+	}
+}
+
+//  Integrate particles begin to end - 1.  The bulk runs PARTICLE_SIMD_WIDTH
+//  lanes at a time; the tail (and non-SIMD builds) use the scalar loop.
+//  begin must be a multiple of 8 so the aligned loads stay aligned.
+//
+void ParticleStore::integrate(int begin, int end, float dt) {
+	int simdEnd = begin;
+
+#if PARTICLE_SIMD_WIDTH == 8
+	simdEnd = begin + ((end - begin) & ~7);
+	const __m256 vdt = _mm256_set1_ps(dt);
+	const __m256 one = _mm256_set1_ps(1.0f);
+	const __m256 zero = _mm256_setzero_ps();
+	float *p[3] = { px.data(), py.data(), pz.data() };
+	float *v[3] = { vx.data(), vy.data(), vz.data() };
+	float *a[3] = { ax.data(), ay.data(), az.data() };
+	float *f[3] = { fx.data(), fy.data(), fz.data() };
+	for (int i = begin; i < simdEnd; i += 8) {
+		__m256 invMass = _mm256_div_ps(one, _mm256_load_ps(&mass[i]));
+		__m256 damp = _mm256_load_ps(&damping[i]);
+		for (int c = 0; c < 3; c++) {
+			__m256 vel = _mm256_load_ps(v[c] + i);
+			__m256 acc = _mm256_add_ps(_mm256_load_ps(a[c] + i), _mm256_mul_ps(_mm256_load_ps(f[c] + i), invMass));
+			_mm256_store_ps(p[c] + i, _mm256_add_ps(_mm256_load_ps(p[c] + i), _mm256_mul_ps(vel, vdt)));
+			_mm256_store_ps(v[c] + i, _mm256_mul_ps(_mm256_add_ps(vel, _mm256_mul_ps(acc, vdt)), damp));
+			_mm256_store_ps(f[c] + i, zero);
+		}
+	}
+#elif PARTICLE_SIMD_WIDTH == 4
+	simdEnd = begin + ((end - begin) & ~3);
+	const __m128 vdt = _mm_set1_ps(dt);
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 zero = _mm_setzero_ps();
+	float *p[3] = { px.data(), py.data(), pz.data() };
+	float *v[3] = { vx.data(), vy.data(), vz.data() };
+	float *a[3] = { ax.data(), ay.data(), az.data() };
+	float *f[3] = { fx.data(), fy.data(), fz.data() };
+	for (int i = begin; i < simdEnd; i += 4) {
+		__m128 invMass = _mm_div_ps(one, _mm_load_ps(&mass[i]));
+		__m128 damp = _mm_load_ps(&damping[i]);
+		for (int c = 0; c < 3; c++) {
+			__m128 vel = _mm_load_ps(v[c] + i);
+			__m128 acc = _mm_add_ps(_mm_load_ps(a[c] + i), _mm_mul_ps(_mm_load_ps(f[c] + i), invMass));
+			_mm_store_ps(p[c] + i, _mm_add_ps(_mm_load_ps(p[c] + i), _mm_mul_ps(vel, vdt)));
+			_mm_store_ps(v[c] + i, _mm_mul_ps(_mm_add_ps(vel, _mm_mul_ps(acc, vdt)), damp));
+			_mm_store_ps(f[c] + i, zero);
+		}
+	}
+#endif
+
+	integrateScalar(simdEnd, end, dt);
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "ofMain.h"
+#include "Particle.h"
+
+//  Number of allocations made through AlignedAllocator, so it can be
+//  checked that the particle arrays stop allocating once they are sized.
+//
+extern atomic<int> alignedAllocCount;
+
+//  Allocator that returns memory aligned for SIMD loads.
+//
+template <class T, size_t Align>
+struct AlignedAllocator {
+	typedef T value_type;
+	template <class U> struct rebind { typedef AlignedAllocator<U, Align> other; };
+
+	AlignedAllocator() {}
+	template <class U> AlignedAllocator(const AlignedAllocator<U, Align> &) {}
+
+	T *allocate(size_t n) {
+		void *raw = malloc(n * sizeof(T) + Align + sizeof(void *));
+		if (raw == NULL) throw bad_alloc();
+		alignedAllocCount++;
+		uintptr_t p = (uintptr_t(raw) + sizeof(void *) + Align - 1) & ~uintptr_t(Align - 1);
+		((void **)p)[-1] = raw;
+		return (T *)p;
+	}
+	void deallocate(T *p, size_t) {
+		if (p) free(((void **)p)[-1]);
+	}
+	template <class U> bool operator==(const AlignedAllocator<U, Align> &) const { return true; }
+	template <class U> bool operator!=(const AlignedAllocator<U, Align> &) const { return false; }
+};
+
+typedef vector<float, AlignedAllocator<float, 32> > FloatArray;
+
+//  Structure-of-arrays storage for a particle system.
+//
+//  Each particle attribute lives in its own 32 byte aligned array so that
+//  integrate() can run as a SIMD kernel (AVX when the compiler targets
+//  it, SSE2 otherwise, plain scalar code as a fallback).  Particles go in
+//  and out as the usual Particle value type through add()/get()/set().
+//
+//  reserve() sizes every array up front; after that add() is a constant
+//  time append into reserved space and removal is a flag plus one
+//  compact() pass, so the store never touches the heap again as long as
+//  it stays within the reserved size.
+//
+class ParticleStore {
+public:
+	int size() const { return int(px.size()); }
+	void reserve(int n);
+	void add(const Particle &);
+	Particle get(int i) const;
+	void set(int i, const Particle &);
+	void remove(int i);
+	int compact(const vector<char> &dead);
+	void rotate(int first);         // particle "first" becomes particle 0, order kept
+	void clear();
+	void integrate(float dt) { integrate(0, size(), dt); }
+	void integrate(int begin, int end, float dt);
+	void integrateScalar(int begin, int end, float dt);
+
+	FloatArray px, py, pz;          // position
+	FloatArray vx, vy, vz;          // velocity
+	FloatArray ax, ay, az;          // acceleration
+	FloatArray fx, fy, fz;          // accumulated forces (cleared each step)
+	FloatArray mass;
+	FloatArray damping;
+	FloatArray lifespan;            // sec
+	FloatArray birthtime;           // ms
+	FloatArray radius;
+	vector<ofColor, AlignedAllocator<ofColor, 32> > color;
+};
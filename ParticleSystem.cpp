@@ -2,58 +2,115 @@
 // Kevin M.Smith - CS 134 SJSU
 
 #include "ParticleSystem.h"
+#include "Profiler.h"
+#include "JobSystem.h"
 
-void ParticleSystem::add(const Particle &p) {
-	particles.push_back(p);
+//  Give the system a fixed pool of n particles.  All per-particle arrays
+//  are sized for n here, so spawning and expiring particles afterwards
+//  does no heap allocation.
+//
+void ParticleSystem::setCapacity(int n, OverflowPolicy policy) {
+	capacity = n;
+	overflow = policy;
+	particles.reserve(n);
+	dead.reserve(n);
+	chunkDead.reserve((n + 7) / 8);
+	found.reserve(n);
+}
+
+//  Add a particle.  When the system is full, the overflow policy decides:
+//  the particle is dropped (returns false) or replaces the oldest one.
+//
+bool ParticleSystem::add(const Particle &p) {
+	if (capacity > 0 && particles.size() >= capacity) {
+		if (overflow == OverflowDrop) {
+			dropped++;
+			return false;
+		}
+		// particles stay in the order they were added (removal keeps
+		// the order), rotated by the recycle cursor: [recycleNext, size)
+		// are older than [0, recycleNext).  Overwriting the oldest and
+		// stepping the cursor keeps it that way, so there is no search.
+		//
+		if (recycleNext >= particles.size()) recycleNext = 0;
+		particles.set(recycleNext, p);
+		recycleNext = (recycleNext + 1) % particles.size();
+		recycled++;
+	}
+	else {
+		// appending needs the oldest back at 0, once per time the
+		// system drops below capacity after recycling
+		//
+		if (recycleNext > 0 && recycleNext < particles.size()) particles.rotate(recycleNext);
+		recycleNext = 0;
+		particles.add(p);
+	}
+	indexDirty = true;
+	return true;
 }
 
 void ParticleSystem::addForce(ParticleForce *f) {
-	f->applied = false;
 	forces.push_back(f);
+	applied.resize(forces.size());
+	applied.back() = false;
 }
 
 void ParticleSystem::remove(int i) {
-	particles.erase(particles.begin() + i);
+	if (i < recycleNext) recycleNext--;
+	particles.remove(i);
+	indexDirty = true;
 }
 
 void ParticleSystem::setLifespan(float l) {
 	for (int i = 0; i < particles.size(); i++) {
-		particles[i].lifespan = l;
+		particles.lifespan[i] = l;
 	}
 }
 
+//  Remove all particles at once
+//
+void ParticleSystem::clear() {
+	particles.clear();
+	recycleNext = 0;
+	indexDirty = true;
+}
+
+//  Re-arm the one shot forces
+//
 void ParticleSystem::reset() {
-	for (int i = 0; i < forces.size(); i++) {
-		forces[i]->applied = false;
-	}
+	applied.assign(forces.size(), false);
 }
 
-void ParticleSystem::update() {
+//  dt is the simulation step in seconds, now the simulation time in ms
+//
+//  The particles are split into chunks.  Each chunk applies the forces,
+//  integrates and flags its expired particles on its own (in parallel
+//  mode as jobs), then the expired ones are removed in one
+//  compaction pass.  Every chunk draws from a random stream seeded from
+//  this system's rng and the chunk number, so the result doesn't depend
+//  on which thread ran which chunk.
+//
+void ParticleSystem::update(float dt, float now) {
 	// check if empty and just return
 	if (particles.size() == 0) return;
+	PROFILE_SCOPE("ParticleSystem::update");
+	indexDirty = true;
 
-	vector<Particle>::iterator p = particles.begin();
-	vector<Particle>::iterator tmp;
+	int n = particles.size();
+	int chunk = max(8, chunkSize & ~7);
+	int chunks = (n + chunk - 1) / chunk;
+	dead.resize(n);
+	chunkDead.resize(chunks);
+	stepDt = dt;
+	stepNow = now;
+	stepSeed = (uint64_t(rng.next()) << 32) | rng.next();
+	applied.resize(forces.size(), false);   // forces may be pushed directly
 
-	// check which particles have exceed their lifespan and delete
-	// from list.  When deleting multiple objects from a vector while
-	// traversing at the same time, we need to use an iterator.
-	//
-	while (p != particles.end()) {
-		if (p->lifespan != -1 && p->age() > p->lifespan) {
-			tmp = particles.erase(p);
-			p = tmp;
-		}
-		else p++;
+	if (parallel && chunks > 1) {
+		jobSystem.parallelFor(chunks, [this](int c) { updateChunk(c); });
 	}
-
-	// update forces on all particles first 
-	//
-	for (int i = 0; i < particles.size(); i++) {
-		for (int k = 0; k < forces.size(); k++) {
-			if (!forces[k]->applied)
-				forces[k]->updateForce( &particles[i] );
-		}
+	else {
+		for (int c = 0; c < chunks; c++) updateChunk(c);
 	}
 
 	// update all forces only applied once to "applied"
@@ -61,28 +118,104 @@ void ParticleSystem::update() {
 	//
 	for (int i = 0; i < forces.size(); i++) {
 		if (forces[i]->applyOnce)
-			forces[i]->applied = true;
+			applied[i] = true;
 	}
 
-	// integrate all the particles in the store
+	// remove the expired particles in one pass (linear no matter how
+	// many expire at once)
 	//
-	for (int i = 0; i < particles.size(); i++)
-		particles[i].integrate();
+	int nDead = 0;
+	for (int c = 0; c < chunks; c++) nDead += chunkDead[c];
+	if (nDead > 0) compactDead();
+}
 
+//  Remove the particles flagged in "dead", keeping the recycle cursor on
+//  the same (oldest) particle
+//
+int ParticleSystem::compactDead() {
+	int survivors = 0;
+	for (int i = 0; i < recycleNext && i < particles.size(); i++) survivors += !dead[i];
+	recycleNext = survivors;
+	return particles.compact(dead);
 }
 
-// remove all particlies within "dist" of point (not implemented as yet)
+void ParticleSystem::updateChunk(int c) {
+	int chunk = max(8, chunkSize & ~7);
+	int begin = c * chunk;
+	int end = min(particles.size(), begin + chunk);
+	FastRandom chunkRng(stepSeed + c);
+
+	// forces on the chunk first, one batch per force
+	//
+	for (int k = 0; k < forces.size(); k++) {
+		if (!applied[k])
+			forces[k]->updateForces(particles, begin, end, chunkRng);
+	}
+
+	// integrate (SIMD kernel)
+	//
+	particles.integrate(begin, end, stepDt);
+
+	// flag the particles that have exceeded their lifespan
+	//
+	const float *birth = particles.birthtime.data(), *life = particles.lifespan.data();
+	int nDead = 0;
+	for (int i = begin; i < end; i++) {
+		float age = (stepNow - birth[i]) / 1000.0;
+		dead[i] = (life[i] != -1 && age > life[i]);
+		nDead += dead[i];
+	}
+	chunkDead[c] = nDead;
+}
+
+//  (Re)build the spatial index if particles were added, removed or moved
+//  since the last query.  At most once per tick in normal use.
 //
-int ParticleSystem::removeNear(const ofVec3f & point, float dist) { return 0; }
+void ParticleSystem::buildIndex() {
+	if (!indexDirty) return;
+	index.build(particles, indexCellSize);
+	indexDirty = false;
+}
 
-//  draw the particle cloud
+// remove all particlies within "dist" of point, return number removed
 //
-void ParticleSystem::draw() {
-	for (int i = 0; i < particles.size(); i++) {
-		particles[i].draw();
-	}
+int ParticleSystem::removeNear(const ofVec3f & point, float dist) {
+	found.clear();
+	queryRadius(point, dist, found);
+	if (found.empty()) return 0;
+
+	dead.assign(particles.size(), 0);
+	for (int k = 0; k < found.size(); k++) dead[found[k]] = 1;
+	int count = compactDead();
+	indexDirty = true;
+	return count;
 }
 
+//  Append the indices of all particles within "dist" of point
+//
+void ParticleSystem::queryRadius(const ofVec3f &point, float dist, vector<int> &out) {
+	buildIndex();
+	index.queryRadius(particles, point, dist, out);
+}
+
+//  Append the indices of all particles whose x/y is inside rect
+//
+void ParticleSystem::queryRect(const ofRectangle &rect, vector<int> &out) {
+	buildIndex();
+	index.queryRect(particles, rect, out);
+}
+
+//  Default batch version: gather each particle, apply the single
+//  particle force and scatter it back.  Keeps user forces that only
+//  implement updateForce() working.
+//
+void ParticleForce::updateForces(ParticleStore &store, int begin, int end, FastRandom &rng) {
+	for (int i = begin; i < end; i++) {
+		Particle p = store.get(i);
+		updateForce(&p, rng);
+		store.set(i, p);
+	}
+}
 
 // Gravity Force Field 
 //
@@ -97,6 +230,16 @@ void GravityForce::updateForce(Particle * particle) {
 	particle->forces += gravity * particle->mass;
 }
 
+void GravityForce::updateForces(ParticleStore &store, int begin, int end, FastRandom &) {
+	const float *mass = store.mass.data();
+	float *fx = store.fx.data(), *fy = store.fy.data(), *fz = store.fz.data();
+	for (int i = begin; i < end; i++) {
+		fx[i] += gravity.x * mass[i];
+		fy[i] += gravity.y * mass[i];
+		fz[i] += gravity.z * mass[i];
+	}
+}
+
 // Turbulence Force Field 
 //
 TurbulenceForce::TurbulenceForce(const ofVec3f &min, const ofVec3f &max) {
@@ -114,6 +257,33 @@ void TurbulenceForce::updateForce(Particle * particle) {
 	particle->forces.z += ofRandom(tmin.z, tmax.z);
 } 
 
+void TurbulenceForce::updateForce(Particle *particle, FastRandom &rng) {
+	particle->forces.x += rng.uniform(tmin.x, tmax.x);
+	particle->forces.y += rng.uniform(tmin.y, tmax.y);
+	particle->forces.z += rng.uniform(tmin.z, tmax.z);
+}
+
+void TurbulenceForce::updateForces(ParticleStore &store, int begin, int end, FastRandom &rng) {
+
+	// random numbers are made a block at a time on the stack, so ranges
+	// of the same store can run on several threads at once
+	//
+	float rx[ForceBlock], ry[ForceBlock], rz[ForceBlock];
+	for (int b = begin; b < end; b += ForceBlock) {
+		int n = min(ForceBlock, end - b);
+		rng.fillUniform(rx, n, tmin.x, tmax.x);
+		rng.fillUniform(ry, n, tmin.y, tmax.y);
+		rng.fillUniform(rz, n, tmin.z, tmax.z);
+
+		float *fx = store.fx.data() + b, *fy = store.fy.data() + b, *fz = store.fz.data() + b;
+		for (int k = 0; k < n; k++) {
+			fx[k] += rx[k];
+			fy[k] += ry[k];
+			fz[k] += rz[k];
+		}
+	}
+}
+
 // Impulse Radial Force - this is a "one shot" force that
 // eminates radially outward in random directions.
 //
@@ -129,4 +299,28 @@ void ImpulseRadialForce::updateForce(Particle * particle) {
 	//
 	ofVec3f dir = ofVec3f(ofRandom(-1, 1), ofRandom(-1,1), ofRandom(-1, 1));
 	particle->forces += dir.getNormalized() * magnitude;
-}
\ No newline at end of file
+}
+
+void ImpulseRadialForce::updateForce(Particle *particle, FastRandom &rng) {
+	ofVec3f dir = ofVec3f(rng.uniform(-1, 1), rng.uniform(-1, 1), rng.uniform(-1, 1));
+	particle->forces += dir.getNormalized() * magnitude;
+}
+
+void ImpulseRadialForce::updateForces(ParticleStore &store, int begin, int end, FastRandom &rng) {
+
+	// random unit directions go into a block on the stack first so the
+	// accumulate loop below is straight array math
+	//
+	float dx[ForceBlock], dy[ForceBlock], dz[ForceBlock];
+	for (int b = begin; b < end; b += ForceBlock) {
+		int n = min(ForceBlock, end - b);
+		rng.fillDirections(dx, dy, dz, n, ofVec3f(1, 1, 1));
+
+		float *fx = store.fx.data() + b, *fy = store.fy.data() + b, *fz = store.fz.data() + b;
+		for (int k = 0; k < n; k++) {
+			fx[k] += dx[k] * magnitude;
+			fy[k] += dy[k] * magnitude;
+			fz[k] += dz[k] * magnitude;
+		}
+	}
+}
@@ -3,30 +3,85 @@
 
 #include "ofMain.h"
 #include "Particle.h"
+#include "ParticleStore.h"
+#include "ParticleIndex.h"
+#include "FastRandom.h"
 
 
 //  Pure Virtual Function Class - must be subclassed to create new forces.
 //
+//  updateForce() works on one particle at a time.  The system calls
+//  updateForces() with a whole range of the store instead; the default
+//  version adapts it to updateForce() with the chunk's rng, and forces
+//  that care about speed override it with a loop over the arrays.
+//  Random forces should draw from the rng they are given (one stream per
+//  chunk of the system), never from ofRandom(), which is neither
+//  reproducible nor safe to call from several threads.
+//
+//  In parallel mode updateForces() is called from several threads at
+//  once on disjoint ranges, so it must not keep per call state in the
+//  force or the store.  Batch kernels work on blocks of ForceBlock
+//  particles in stack arrays.
+//
+const int ForceBlock = 256;
+
 class ParticleForce {
 protected:
 public:
-	bool applyOnce = false;
-	bool applied = false;
+	bool applyOnce = false;         // the system applies it once until reset()
+	virtual ~ParticleForce() {}
 	virtual void updateForce(Particle *) = 0;
+	virtual void updateForce(Particle *p, FastRandom &) { updateForce(p); }
+	virtual void updateForces(ParticleStore &store, int begin, int end, FastRandom &rng);
 }; 
 
+//  What add() does when the system is at its capacity: drop the new
+//  particle, or overwrite the oldest live one (the one added first)
+//  with it.
+//
+typedef enum { OverflowDrop, OverflowRecycleOldest } OverflowPolicy;
+
 class ParticleSystem {
 public:
-	void add(const Particle &);
+	void setCapacity(int n, OverflowPolicy policy = OverflowDrop);
+	bool add(const Particle &);
 	void addForce(ParticleForce *);
 	void remove(int);
-	void update();
+	void update(float dt, float now);
 	void setLifespan(float);
 	void reset();
+	void clear();
 	int removeNear(const ofVec3f & point, float dist);
-	void draw();
-	vector<Particle> particles;
-	vector<ParticleForce *> forces;
+	void queryRadius(const ofVec3f &point, float dist, vector<int> &out);
+	void queryRect(const ofRectangle &rect, vector<int> &out);
+	ParticleStore particles;        // structure-of-arrays storage
+	vector<ParticleForce *> forces;         // may be shared between systems
+	FastRandom rng;                 // used by forces and emitters of this system
+	float indexCellSize = 32;       // cell size of the query index
+	int capacity = 0;               // hard limit on live particles, 0 = none
+	OverflowPolicy overflow = OverflowDrop;
+	int dropped = 0;                // particles lost to the capacity limit
+	int recycled = 0;               // particles overwritten by newer ones
+
+	// update() works on chunks of chunkSize particles, each with its own
+	// random stream, so running the chunks as jobs (parallel)
+	// gives bitwise the same result as running them in order
+	//
+	bool parallel = false;
+	int chunkSize = 4096;           // multiple of 8, about L2 sized
+private:
+	void buildIndex();
+	void updateChunk(int chunk);
+	int compactDead();
+	vector<char> applied;           // per force: one shot force already applied
+	vector<char> dead;              // scratch flags for compaction
+	vector<int> chunkDead;          // expired particles per chunk
+	int recycleNext = 0;            // oldest particle, see add()
+	float stepDt = 0, stepNow = 0;  // arguments of the update() in progress
+	uint64_t stepSeed = 0;
+	ParticleIndex index;            // Morton ordered, rebuilt lazily
+	bool indexDirty = true;
+	vector<int> found;
 };
 
 
@@ -38,6 +93,7 @@ class GravityForce: public ParticleForce {
 public:
 	GravityForce(const ofVec3f & gravity);
 	void updateForce(Particle *);
+	void updateForces(ParticleStore &store, int begin, int end, FastRandom &rng);
 };
 
 class TurbulenceForce : public ParticleForce {
@@ -45,6 +101,8 @@ class TurbulenceForce : public ParticleForce {
 public:
 	TurbulenceForce(const ofVec3f & min, const ofVec3f &max);
 	void updateForce(Particle *);
+	void updateForce(Particle *, FastRandom &rng);
+	void updateForces(ParticleStore &store, int begin, int end, FastRandom &rng);
 };
 
 class ImpulseRadialForce : public ParticleForce {
@@ -56,4 +114,6 @@ public:
 	ImpulseRadialForce() {}
 	ImpulseRadialForce(float magnitude); 
 	void updateForce(Particle *);
+	void updateForce(Particle *, FastRandom &rng);
+	void updateForces(ParticleStore &store, int begin, int end, FastRandom &rng);
 };
@@ -0,0 +1,101 @@
+#include "PathEngine.h"
+
+// pixels between the points of a baked table, and how many curve
+// samples are measured per table point
+//
+static const float pathSpacing = 2;
+static const int pathOversample = 8;
+
+ofVec2f PathTable::at(float distance) const {
+	int n = int(points.size());
+	if (n == 0) return ofVec2f(0, 0);
+	if (n == 1) return points[0];
+	float u = distance / step;
+	int i = int(floor(u));
+	i = min(max(i, 0), n - 2);
+	float f = u - i;
+	return points[i] + (points[i + 1] - points[i]) * f;
+}
+
+//  Sample the curve finely, then walk the samples laying down a table
+//  point every pathSpacing pixels of arc length
+//
+PathTable PathEngine::bake(const Curve &curve, float duration) {
+	PathTable table;
+
+	// a first coarse pass finds roughly how long the curve is, so the
+	// fine pass takes enough samples for the table
+	//
+	float roughLength = 0;
+	ofVec2f last = curve(0);
+	for (int i = 1; i <= 64; i++) {
+		ofVec2f p = curve(i / 64.0);
+		roughLength += (p - last).length();
+		last = p;
+	}
+	int nSamples = max(2, int(ceil(roughLength / pathSpacing)) * pathOversample + 1);
+
+	vector<ofVec2f> samples(nSamples);
+	vector<float> distances(nSamples);
+	distances[0] = 0;
+	samples[0] = curve(0);
+	for (int i = 1; i < nSamples; i++) {
+		samples[i] = curve(float(i) / (nSamples - 1));
+		distances[i] = distances[i - 1] + (samples[i] - samples[i - 1]).length();
+	}
+	table.length = distances[nSamples - 1];
+
+	// table points at equal arc length from the start to the end of the
+	// curve
+	//
+	int nPoints = max(2, int(ceil(table.length / pathSpacing)) + 1);
+	table.step = table.length > 0 ? table.length / (nPoints - 1) : pathSpacing;
+	table.points.resize(nPoints);
+	int k = 0;
+	for (int i = 0; i < nPoints; i++) {
+		float d = i * table.step;
+		while (k < nSamples - 2 && distances[k + 1] < d) k++;
+		float span = distances[k + 1] - distances[k];
+		float f = span > 0 ? (d - distances[k]) / span : 0;
+		f = min(max(f, 0.0f), 1.0f);
+		table.points[i] = samples[k] + (samples[k + 1] - samples[k]) * f;
+	}
+	table.speed = duration > 0 ? table.length / duration : 0;
+	return table;
+}
+
+//  Catmull-Rom spline through the control points, each segment gets an
+//  equal share of t
+//
+PathTable PathEngine::bakeSpline(const vector<ofVec2f> &controls, float duration) {
+	if (controls.size() < 2) {
+		ofLogError("PathEngine") << "bakeSpline: need at least 2 control points, got " << controls.size();
+		PathTable table;
+		table.points = controls;
+		table.step = pathSpacing;
+		return table;
+	}
+	int nSegments = int(controls.size()) - 1;
+	Curve curve = [&controls, nSegments](float t) {
+		float u = t * nSegments;
+		int i = min(int(u), nSegments - 1);
+		float f = u - i;
+		const ofVec2f &p0 = controls[max(i - 1, 0)];
+		const ofVec2f &p1 = controls[i];
+		const ofVec2f &p2 = controls[i + 1];
+		const ofVec2f &p3 = controls[min(i + 2, nSegments)];
+		float f2 = f * f, f3 = f2 * f;
+		return (p1 * 2 + (p2 - p0) * f + (p0 * 2 - p1 * 5 + p2 * 4 - p3) * f2 + (p1 * 3 - p0 - p2 * 3 + p3) * f3) * 0.5;
+	};
+	return bake(curve, duration);
+}
+
+//  Replace path "id", growing the set if needed.  The old set is left
+//  alone for anyone still holding it.
+//
+void PathEngine::set(int id, const PathTable &table) {
+	shared_ptr<Tables> next = tables ? make_shared<Tables>(*tables) : make_shared<Tables>();
+	if (id >= int(next->size())) next->resize(id + 1);
+	(*next)[id] = table;
+	tables = next;
+}
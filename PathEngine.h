@@ -0,0 +1,44 @@
+#pragma once
+#include "ofMain.h"
+
+//  A curve baked into points spaced evenly along its length, so moving a
+//  given distance along it is a table lookup and a lerp.
+//
+struct PathTable {
+	ofVec2f at(float distance) const;       // past either end it carries on along the end segment
+
+	vector<ofVec2f> points;     // points[i] is i * step along the curve from its start
+	float step = 0;
+	float length = 0;
+	float speed = 0;            // pixels/sec along the path
+};
+
+//  The paths things in the game follow, baked once (and again when the
+//  play field changes) instead of evaluating curves every tick.
+//
+//  Curves are given as a function of t in [0, 1], or as spline control
+//  points.  bake() samples the curve densely, measures its length and
+//  resamples it by arc length, so the table spacing (and the speed of
+//  anything moving along it) doesn't depend on how t maps to the curve.
+//
+//  The tables are published as one immutable set: set() swaps in a new
+//  set and anyone holding the old one (e.g. a RenderSnapshot on the draw
+//  thread) keeps a valid copy.
+//
+class PathEngine {
+public:
+	typedef std::function<ofVec2f (float t)> Curve;
+	typedef vector<PathTable> Tables;
+
+	static PathTable bake(const Curve &curve, float duration);      // duration: sec to travel the whole curve
+	static PathTable bakeSpline(const vector<ofVec2f> &controls, float duration);
+
+	void set(int id, const PathTable &table);
+	void clear() { tables.reset(); }
+	const PathTable &get(int id) const { return (*tables)[id]; }
+	int size() const { return tables ? int(tables->size()) : 0; }
+	shared_ptr<const Tables> getTables() const { return tables; }
+
+private:
+	shared_ptr<const Tables> tables;
+};
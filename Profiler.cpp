@@ -0,0 +1,137 @@
+#include "Profiler.h"
+
+Profiler profiler;
+
+//  Index of the phase called "name", added on first use.  Each
+//  PROFILE_SCOPE calls this once and keeps the index.
+//
+int Profiler::phaseIndex(const char *name) {
+	std::lock_guard<std::mutex> guard(lock);
+	for (int i = 0; i < phases.size(); i++) {
+		if (phases[i].name == name) return i;
+	}
+	phases.push_back(Phase());
+	phases.back().name = name;
+	return int(phases.size()) - 1;
+}
+
+//  The calling thread's buffer, registered on its first scope
+//
+Profiler::ThreadBuffer &Profiler::threadBuffer() {
+	static thread_local ThreadBuffer *buffer = nullptr;
+	if (!buffer) {
+		std::lock_guard<std::mutex> guard(lock);
+		buffers.push_back(std::unique_ptr<ThreadBuffer>(new ThreadBuffer()));
+		buffer = buffers.back().get();
+		buffer->thread = std::hash<std::thread::id>()(std::this_thread::get_id());
+	}
+	return *buffer;
+}
+
+//  Samples wait in the thread's own buffer until endFrame(); a frame
+//  that never ends keeps at most maxPending of them per thread.
+//
+void Profiler::record(int phase, uint64_t start, uint64_t end) {
+	const size_t maxPending = 1 << 16;
+	ThreadBuffer &b = threadBuffer();
+	std::lock_guard<std::mutex> guard(b.lock);
+	if (b.events.size() >= maxPending) return;
+	TraceEvent e = { phase, start, end, b.thread };
+	b.events.push_back(e);
+}
+
+//  Call once at the end of each frame: moves the samples every thread
+//  recorded into the phase rings (and the trace while capturing), and
+//  writes the trace when a capture is complete
+//
+void Profiler::endFrame() {
+	std::lock_guard<std::mutex> guard(lock);
+	for (int i = 0; i < buffers.size(); i++) {
+		{
+			std::lock_guard<std::mutex> bufferGuard(buffers[i]->lock);
+			drained.swap(buffers[i]->events);
+		}
+		for (int k = 0; k < drained.size(); k++) {
+			const TraceEvent &e = drained[k];
+			Phase &p = phases[e.phase];
+			float ms = (e.end - e.start) / 1e6f;
+			if (p.samples.size() < window) {
+				p.samples.push_back(ms);
+			}
+			else {
+				p.samples[p.next] = ms;
+				p.next = (p.next + 1) % window;
+			}
+			if (captureFrames > 0) trace.push_back(e);
+		}
+		drained.clear();
+	}
+	if (captureFrames > 0 && --captureFrames == 0) writeTrace();
+}
+
+bool Profiler::isCapturing() {
+	std::lock_guard<std::mutex> guard(lock);
+	return captureFrames > 0;
+}
+
+//  Record every scope of the next "frames" frames into "path" (in the
+//  data folder).  Turns the profiler on.
+//
+void Profiler::startCapture(int frames, const string &path) {
+	std::lock_guard<std::mutex> guard(lock);
+	enabled = true;
+	trace.clear();
+	captureFrames = frames;
+	capturePath = path;
+}
+
+void Profiler::writeTrace() {
+	ofstream out(ofToDataPath(capturePath).c_str());
+	if (!out) {
+		ofLogError("Profiler") << "can't write " << capturePath;
+		return;
+	}
+
+	// Chrome trace_event format: complete ("X") events, times in us
+	//
+	map<size_t, int> threadIds;
+	uint64_t origin = trace.empty() ? 0 : trace[0].start;
+	for (int i = 0; i < trace.size(); i++) origin = min(origin, trace[i].start);
+	out << "{\"traceEvents\":[" << endl;
+	for (int i = 0; i < trace.size(); i++) {
+		const TraceEvent &e = trace[i];
+		if (threadIds.count(e.thread) == 0) {
+			int id = int(threadIds.size()) + 1;
+			threadIds[e.thread] = id;
+		}
+		out << "{\"name\":\"" << phases[e.phase].name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << threadIds[e.thread]
+			<< ",\"ts\":" << (e.start - origin) / 1000.0 << ",\"dur\":" << (e.end - e.start) / 1000.0 << "}"
+			<< (i + 1 < trace.size() ? "," : "") << endl;
+	}
+	out << "]}" << endl;
+	ofLogNotice("Profiler") << "wrote " << trace.size() << " events to " << capturePath;
+	trace.clear();
+}
+
+//  One line per phase: rolling average and p99 in ms.  The app draws
+//  them, the profiler itself has no drawing code.
+//
+void Profiler::getOverlay(vector<string> &lines) {
+	std::lock_guard<std::mutex> guard(lock);
+	lines.clear();
+	vector<float> sorted;
+	for (int i = 0; i < phases.size(); i++) {
+		const Phase &p = phases[i];
+		if (p.samples.empty()) continue;
+		sorted = p.samples;
+		std::sort(sorted.begin(), sorted.end());
+		float sum = 0;
+		for (int k = 0; k < sorted.size(); k++) sum += sorted[k];
+		float avg = sum / sorted.size();
+		float p99 = sorted[min(int(sorted.size()) - 1, int(sorted.size() * 0.99f))];
+		lines.push_back(p.name + "  avg " + ofToString(avg, 3) + " ms  p99 " + ofToString(p99, 3) + " ms");
+	}
+	if (captureFrames > 0) {
+		lines.push_back("capturing trace (" + ofToString(captureFrames) + " frames left)");
+	}
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include "ofMain.h"
+#include <chrono>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <memory>
+
+//  Scoped frame profiler.
+//
+//  PROFILE_SCOPE("name") at the top of a block times the block.  While
+//  profiler.enabled is false a scope costs one flag test on entry and
+//  exit; build with NO_PROFILER to compile the scopes out entirely.
+//  When enabled, each phase keeps its last "window" samples for the
+//  overlay (average and p99), and startCapture() records every scope of
+//  the next few frames into a Chrome trace_event file (chrome://tracing
+//  or ui.perfetto.dev).  Scopes append to a buffer owned by their
+//  thread, so job workers never wait on each other; endFrame() folds
+//  the buffers into the phases.
+//
+class Profiler {
+public:
+	int phaseIndex(const char *name);
+	void record(int phase, uint64_t start, uint64_t end);
+	void endFrame();
+	void startCapture(int frames, const string &path = "trace.json");
+	bool isCapturing();
+	void getOverlay(vector<string> &lines);     // text for the app's overlay
+
+	static uint64_t nowNanos() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	std::atomic<bool> enabled{ false };     // toggled by the app, read by scopes on any thread
+	int window = 240;           // samples per phase for the overlay
+
+private:
+	struct Phase {
+		string name;
+		vector<float> samples;  // ms, ring buffer of "window" entries
+		int next = 0;
+	};
+	struct TraceEvent {
+		int phase;
+		uint64_t start, end;    // ns
+		size_t thread;
+	};
+	struct ThreadBuffer {
+		std::mutex lock;        // only contended while endFrame() drains it
+		vector<TraceEvent> events;  // scopes since the last endFrame()
+		size_t thread;
+	};
+	ThreadBuffer &threadBuffer();
+	void writeTrace();          // with "lock" held
+
+	std::mutex lock;            // guards everything below
+	vector<Phase> phases;
+	vector<TraceEvent> trace;
+	vector<std::unique_ptr<ThreadBuffer>> buffers;
+	vector<TraceEvent> drained; // scratch for endFrame()
+	int captureFrames = 0;
+	string capturePath;
+};
+
+extern Profiler profiler;
+
+class ProfileScope {
+public:
+	ProfileScope(int phase) : phase(phase), start(profiler.enabled ? Profiler::nowNanos() : 0) {}
+	~ProfileScope() {
+		if (start) profiler.record(phase, start, Profiler::nowNanos());
+	}
+private:
+	int phase;
+	uint64_t start;
+};
+
+#define PROFILE_CONCAT2(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT2(a, b)
+
+#ifdef NO_PROFILER
+#define PROFILE_SCOPE(name)
+#else
+#define PROFILE_SCOPE(name) \
+	static const int PROFILE_CONCAT(profilePhase, __LINE__) = profiler.phaseIndex(name); \
+	ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(PROFILE_CONCAT(profilePhase, __LINE__))
+#endif
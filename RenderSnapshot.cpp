@@ -0,0 +1,28 @@
+#include "RenderSnapshot.h"
+
+//  Empty the snapshot, keeping the capacity of its arrays so a steady
+//  game doesn't allocate per tick
+//
+void RenderSnapshot::clear() {
+	sprites.clear();
+	px0.clear(); py0.clear(); px1.clear(); py1.clear(); pz.clear();
+	radius.clear();
+	color.clear();
+	markers.clear();
+}
+
+//  Append the particles of "sys".  Particles don't keep their last
+//  position; one step back along the velocity is close enough to draw.
+//
+void RenderSnapshot::addParticles(const ParticleSystem &sys, float dt) {
+	const ParticleStore &p = sys.particles;
+	for (int i = 0; i < p.size(); i++) {
+		px0.push_back(p.px[i] - p.vx[i] * dt);
+		py0.push_back(p.py[i] - p.vy[i] * dt);
+		px1.push_back(p.px[i]);
+		py1.push_back(p.py[i]);
+		pz.push_back(p.pz[i]);
+		radius.push_back(p.radius[i]);
+		color.push_back(p.color[i]);
+	}
+}
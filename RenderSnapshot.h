@@ -0,0 +1,60 @@
+#pragma once
+#include "ofMain.h"
+#include "ParticleSystem.h"
+#include "PathEngine.h"
+
+//  Everything draw() needs from one simulation tick: sprites, particles
+//  and the HUD values, copied out by the simulation thread so the
+//  renderer never reads live game state.
+//
+//  Positions are kept for the previous tick (x0, y0) and this one (x1,
+//  y1).  The renderer draws at a fraction "alpha" of the way between them,
+//  one tick behind the simulation, so motion stays smooth when the
+//  display and the simulation run at different rates.
+//
+//  It is plain data: images are ids the renderer maps back to its own
+//  images, and the drawing is done by SpriteBatch::addSprites() and
+//  ParticleMesh::draw(), so the simulation needs no GL or image code.
+//
+class RenderSnapshot {
+public:
+	struct Quad {
+		int image;                  // sprite image id (see ImageSource), -1: a flat ghost white quad
+		float x0, y0, x1, y1;       // center of the entity
+		float w, h, rot;            // size of the entity, an image is drawn at its own size
+	};
+	struct Marker {                 // a visible particle emitter
+		ofVec3f position;
+		float radius;
+	};
+
+	void clear();
+	void addParticles(const ParticleSystem &sys, float dt);
+
+	vector<Quad> sprites;           // in draw order
+
+	// all particles of the game, structure of arrays
+	//
+	vector<float> px0, py0, px1, py1, pz, radius;
+	vector<ofColor> color;
+	vector<Marker> markers;
+
+	shared_ptr<const PathEngine::Tables> paths;     // baked paths, for the debug view
+
+	// the tick
+	//
+	uint64_t tick = 0;
+	float dt = 1 / 60.0;            // sec
+	double tickTime = 0;            // SimThread::nowSeconds() the tick was due
+
+	// HUD
+	//
+	int score = 0;
+	int gunLife = 0;
+	int level = 0;
+	float playtime = 0;
+	bool startAnim = false;
+	bool gameOver = false;
+	int liveSprites = 0, freeSprites = 0;
+	int refusedSprites = 0;         // spawns refused with the world full
+};
@@ -0,0 +1,3 @@
+#include "RenderStats.h"
+
+RenderStats renderStats;
@@ -0,0 +1,12 @@
+#pragma once
+
+//  Per-frame rendering counters.  Reset at the start of ofApp::draw() and
+//  shown in the debug overlay.
+//
+struct RenderStats {
+	int drawCalls = 0;
+	int quads = 0;
+	void reset() { drawCalls = 0; quads = 0; }
+};
+
+extern RenderStats renderStats;
@@ -0,0 +1,35 @@
+#include "SimClock.h"
+
+SimClock::SimClock(float tickRate) {
+	setTickRate(tickRate);
+	reset();
+}
+
+void SimClock::setTickRate(float hz) {
+	dt = 1.0 / hz;
+}
+
+void SimClock::reset() {
+	accumulator = 0;
+	ticks = 0;
+}
+
+//  Add real elapsed time to the accumulator. Very long frames are clamped
+//  so the simulation doesn't spiral trying to catch up.
+//
+void SimClock::advance(float elapsed) {
+	if (elapsed < 0) return;
+	accumulator += min(elapsed, maxFrameTime);
+}
+
+//  Consume one tick from the accumulator.  Use as:
+//
+//     clock.advance(ofGetLastFrameTime());
+//     while (clock.step()) simulate(clock.getDt(), clock.getNow());
+//
+bool SimClock::step() {
+	if (accumulator < dt) return false;
+	accumulator -= dt;
+	ticks++;
+	return true;
+}
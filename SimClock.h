@@ -0,0 +1,31 @@
+#pragma once
+#include "ofMain.h"
+
+//  Fixed timestep simulation clock.
+//
+//  Real frame time is added to an accumulator with advance(), and step()
+//  then hands out whole ticks of getDt() seconds until the accumulator is
+//  drained.  Everything in the simulation reads dt and "now" from here
+//  (passed down as arguments), so the game advances the same way no matter
+//  what the measured frame rate is.
+//
+class SimClock {
+public:
+	SimClock(float tickRate = 60);
+	void setTickRate(float hz);
+	void reset();
+	void advance(float elapsed);    // real seconds since the last frame
+	bool step();                    // true if another tick should run
+
+	float getDt() const { return dt; }                      // sec per tick
+	float getNow() const { return float(ticks * dt * 1000.0); }  // ms since reset
+	uint64_t getTicks() const { return ticks; }
+	float getAlpha() const { return accumulator / dt; }     // fraction of next tick
+
+	float maxFrameTime = 0.25;      // clamp long frames (debugger, window drag)
+
+private:
+	float dt;
+	float accumulator;
+	uint64_t ticks;
+};
@@ -0,0 +1,110 @@
+#include "SimThread.h"
+#include "Profiler.h"
+#include <chrono>
+
+SimThread::~SimThread() {
+	stop();
+}
+
+double SimThread::nowSeconds() {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//  Publish the current state of "sim" and start ticking it
+//
+void SimThread::start(GameSim *s) {
+	stop();
+	sim = s;
+	sim->events.clear();
+	publish(nowSeconds());
+	quit = false;
+	thread = std::thread(&SimThread::run, this);
+}
+
+//  Stop ticking; the sim belongs to the caller again
+//
+void SimThread::stop() {
+	if (!thread.joinable()) return;
+	quit = true;
+	thread.join();
+	std::lock_guard<std::mutex> guard(inputLock);
+	inputs.clear();
+}
+
+//  Run "input" on the sim thread before the next tick (or right away
+//  when the thread isn't running)
+//
+void SimThread::post(const function<void(GameSim &)> &input) {
+	if (!isRunning()) {
+		if (sim) input(*sim);
+		return;
+	}
+	std::lock_guard<std::mutex> guard(inputLock);
+	inputs.push_back(input);
+}
+
+//  Move the events of the ticks since the last call into "out"
+//
+void SimThread::takeEvents(vector<GameEvent> &out) {
+	out.clear();
+	if (!isRunning() && sim) {
+		out.swap(sim->events);
+		return;
+	}
+	std::lock_guard<std::mutex> guard(eventLock);
+	out.swap(events);
+}
+
+//  The newest published snapshot.  Stays valid until the next call.
+//
+const RenderSnapshot &SimThread::latest() {
+	if (middle.load() & Fresh) reading = middle.exchange(reading) & 3;
+	return buffers[reading];
+}
+
+//  How far the display is between the snapshot's previous tick (0) and
+//  its tick (1).  Drawing one tick behind keeps it an interpolation.
+//
+float SimThread::getAlpha(const RenderSnapshot &s) const {
+	return ofClamp(float((nowSeconds() - s.tickTime) / s.dt), 0, 1);
+}
+
+void SimThread::publish(double tickTime) {
+	RenderSnapshot &s = buffers[writing];
+	sim->capture(s);
+	s.tickTime = tickTime;
+	writing = middle.exchange(writing | Fresh) & 3;
+}
+
+void SimThread::run() {
+	double last = nowSeconds();
+	while (!quit) {
+		{
+			std::lock_guard<std::mutex> guard(inputLock);
+			running.swap(inputs);
+		}
+		for (int i = 0; i < running.size(); i++) running[i](*sim);
+		running.clear();
+
+		double now = nowSeconds();
+		uint64_t ticks = sim->clock.getTicks();
+		sim->update(float(now - last));
+		last = now;
+
+		if (!sim->events.empty()) {
+			std::lock_guard<std::mutex> guard(eventLock);
+			events.insert(events.end(), sim->events.begin(), sim->events.end());
+			sim->events.clear();
+		}
+		float dt = sim->clock.getDt();
+		if (sim->clock.getTicks() != ticks) {
+			PROFILE_SCOPE("publish snapshot");
+			publish(now - sim->clock.getAlpha() * dt);
+		}
+
+		// sleep until the next tick is due
+		//
+		double wait = (1 - sim->clock.getAlpha()) * dt;
+		std::this_thread::sleep_for(std::chrono::duration<double>(wait));
+	}
+}
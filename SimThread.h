@@ -0,0 +1,60 @@
+#pragma once
+#include "ofMain.h"
+#include "GameSim.h"
+#include "RenderSnapshot.h"
+#include <thread>
+#include <mutex>
+
+//  Runs a GameSim on its own thread at the sim clock's tick rate, so a
+//  slow frame doesn't hold up the simulation and vsync doesn't cap it.
+//
+//  After every tick the thread copies the state into a RenderSnapshot
+//  and publishes it through a triple buffer: one snapshot being written,
+//  one being drawn and one in between that the two swap with an atomic
+//  exchange.  latest() never blocks and never sees a half written
+//  snapshot; if the simulation is faster than the display the renderer
+//  just skips snapshots.
+//
+//  While it runs only the thread touches the sim.  Input goes in through
+//  post() and runs on the thread before the next tick; the sim's events
+//  come back out through takeEvents().
+//
+class SimThread {
+public:
+	~SimThread();
+	void start(GameSim *sim);
+	void stop();
+	bool isRunning() const { return thread.joinable(); }
+
+	void post(const function<void(GameSim &)> &input);
+	void takeEvents(vector<GameEvent> &out);
+
+	// render thread only
+	//
+	const RenderSnapshot &latest();
+	float getAlpha(const RenderSnapshot &snapshot) const;
+
+	static double nowSeconds();
+
+private:
+	void run();
+	void publish(double tickTime);
+
+	GameSim *sim = NULL;
+	std::thread thread;
+	atomic<bool> quit{ false };
+
+	std::mutex inputLock;
+	vector<function<void(GameSim &)> > inputs, running;
+
+	std::mutex eventLock;
+	vector<GameEvent> events;
+
+	// triple buffer.  "middle" holds the index of the in between snapshot
+	// plus the Fresh bit when it is newer than the one being drawn.
+	//
+	enum { Fresh = 4 };
+	RenderSnapshot buffers[3];
+	int writing = 0, reading = 1;
+	atomic<int> middle{ 2 };
+};
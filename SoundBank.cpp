@@ -0,0 +1,70 @@
+#include "SoundBank.h"
+
+//  Add an effect and return its id.  Adding the same path again (e.g.
+//  from setup() on a restart) returns the existing effect.
+//
+int SoundBank::add(AssetManager &assets, const string &path, float volume, int maxVoices, float voiceLength, bool loop) {
+	for (int i = 0; i < effects.size(); i++) {
+		if (effects[i].path == path) return i;
+	}
+	Effect e;
+	e.path = path;
+	e.player = assets.getSound(path);
+	e.volume = volume;
+	e.maxVoices = max(1, maxVoices);
+	e.voiceLength = voiceLength;
+	e.loop = loop;
+	e.player->setLoop(loop);
+	e.player->setMultiPlay(e.maxVoices > 1);
+	e.player->setVolume(volume);
+	e.voiceEnds.reserve(e.maxVoices);
+	effects.push_back(e);
+	return int(effects.size()) - 1;
+}
+
+void SoundBank::trigger(int effect, float volume) {
+	Effect &e = effects[effect];
+	if (volume < 0) volume = e.volume;
+	if (e.triggers > 0) stats.coalesced++;
+	e.triggerVolume = e.triggers > 0 ? max(e.triggerVolume, volume) : volume;
+	e.triggers++;
+}
+
+//  Silence every voice of the effect, including triggers not played yet
+//
+void SoundBank::stop(int effect) {
+	Effect &e = effects[effect];
+	e.stopping = true;
+	e.triggers = 0;
+}
+
+void SoundBank::update(float now) {
+	for (int i = 0; i < effects.size(); i++) {
+		Effect &e = effects[i];
+		if (e.stopping) {
+			e.player->stop();
+			e.voiceEnds.clear();
+			e.stopping = false;
+		}
+
+		// voices that have played out no longer count
+		//
+		int w = 0;
+		for (int v = 0; v < e.voiceEnds.size(); v++) {
+			if (e.voiceEnds[v] > now) e.voiceEnds[w++] = e.voiceEnds[v];
+		}
+		e.voiceEnds.resize(w);
+
+		if (e.triggers == 0) continue;
+		if (e.voiceEnds.size() >= e.maxVoices) {
+			stats.dropped++;
+		}
+		else {
+			e.player->setVolume(e.triggerVolume);
+			e.player->play();
+			e.voiceEnds.push_back(e.loop ? std::numeric_limits<float>::max() : now + e.voiceLength);
+			stats.played++;
+		}
+		e.triggers = 0;
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "ofMain.h"
+#include "AssetManager.h"
+
+//  The sound effects of the game.
+//
+//  Each effect is one player decoded once (through AssetManager) and
+//  played as many overlapping voices as its cap allows.  Game code only
+//  calls trigger() and stop(); update(), once a frame, turns all the
+//  triggers of an effect since the last frame into a single voice, so a
+//  burst of twenty hits in one tick starts one blast instead of twenty.
+//  Triggers while an effect already has its cap of voices are dropped.
+//
+//  Players can't report how many of their voices are still sounding, so
+//  every voice counts against the cap for the "voiceLength" given to
+//  add(), or until stop() for looping effects.
+//
+class SoundBank {
+public:
+	struct Stats {
+		int played = 0;         // voices started
+		int coalesced = 0;      // triggers merged into another one of the same frame
+		int dropped = 0;        // triggers over the voice cap
+	};
+
+	int add(AssetManager &assets, const string &path, float volume, int maxVoices, float voiceLength, bool loop = false);
+	void trigger(int effect, float volume = -1);    // -1: the effect volume
+	void stop(int effect);
+	void update(float now);         // sec, e.g. ofGetElapsedTimef()
+	int getVoices(int effect) const { return int(effects[effect].voiceEnds.size()); }
+
+	Stats stats;
+
+private:
+	struct Effect {
+		string path;
+		shared_ptr<ofSoundPlayer> player;
+		float volume = 1;
+		int maxVoices = 1;
+		float voiceLength = 1;  // sec
+		bool loop = false;
+		vector<float> voiceEnds;        // when each live voice stops counting
+		int triggers = 0;       // since the last update()
+		float triggerVolume = 0;        // loudest of them
+		bool stopping = false;
+	};
+	vector<Effect> effects;
+};
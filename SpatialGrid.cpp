@@ -0,0 +1,64 @@
+#include "SpatialGrid.h"
+
+void SpatialGrid::setup(const ofRectangle &a, float size) {
+	area = a;
+	cellSize = size;
+	cols = max(1, int(ceil(area.getWidth() / cellSize)));
+	rows = max(1, int(ceil(area.getHeight() / cellSize)));
+	cellStart.assign(cols * rows + 1, 0);
+	clear();
+}
+
+void SpatialGrid::clear() {
+	pointCell.clear();
+	items.clear();
+}
+
+int SpatialGrid::cellX(float x) const {
+	int c = int(floor((x - area.getLeft()) / cellSize));
+	return min(max(c, 0), cols - 1);
+}
+
+int SpatialGrid::cellY(float y) const {
+	int c = int(floor((y - area.getTop()) / cellSize));
+	return min(max(c, 0), rows - 1);
+}
+
+void SpatialGrid::insert(const ofVec3f &p) {
+	pointCell.push_back(cellY(p.y) * cols + cellX(p.x));
+}
+
+//  Bucket the inserted points by cell (counting sort)
+//
+void SpatialGrid::build() {
+	int nCells = cols * rows;
+	cellStart.assign(nCells + 1, 0);
+	for (int i = 0; i < pointCell.size(); i++) {
+		cellStart[pointCell[i] + 1]++;
+	}
+	for (int c = 0; c < nCells; c++) {
+		cellStart[c + 1] += cellStart[c];
+	}
+	items.resize(pointCell.size());
+	vector<int> &next = scratch;
+	next.assign(cellStart.begin(), cellStart.end() - 1);
+	for (int i = 0; i < pointCell.size(); i++) {
+		items[next[pointCell[i]]++] = i;
+	}
+}
+
+//  Append to "out" the ids of every point in a cell overlapping the
+//  square around p of half-size radius.
+//
+void SpatialGrid::query(const ofVec3f &p, float radius, vector<int> &out) const {
+	int x0 = cellX(p.x - radius), x1 = cellX(p.x + radius);
+	int y0 = cellY(p.y - radius), y1 = cellY(p.y + radius);
+	for (int y = y0; y <= y1; y++) {
+		for (int x = x0; x <= x1; x++) {
+			int c = y * cols + x;
+			for (int k = cellStart[c]; k < cellStart[c + 1]; k++) {
+				out.push_back(items[k]);
+			}
+		}
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "ofMain.h"
+
+//  Uniform grid broadphase over the play area.
+//
+//  Points are added with insert() (their id is the insertion order) and
+//  bucketed by cell with build(), which is a counting sort so rebuilding
+//  every tick costs O(n) and reuses its buffers.  query() returns the ids
+//  of all points in the cells touched by a circle; callers still do the
+//  exact distance test.  Points outside the area are clamped into the
+//  border cells so nothing is ever missed.
+//
+class SpatialGrid {
+public:
+	void setup(const ofRectangle &area, float cellSize);
+	void clear();
+	void insert(const ofVec3f &p);
+	void build();
+	void query(const ofVec3f &p, float radius, vector<int> &out) const;
+	int size() const { return int(pointCell.size()); }
+
+private:
+	int cellX(float x) const;
+	int cellY(float y) const;
+
+	ofRectangle area;
+	float cellSize = 64;
+	int cols = 1, rows = 1;
+	vector<int> pointCell;      // cell of each inserted point
+	vector<int> cellStart;      // items[cellStart[c] .. cellStart[c+1]) are in cell c
+	vector<int> items;          // point ids sorted by cell
+	vector<int> scratch;        // fill cursors used by build()
+};
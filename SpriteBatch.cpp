@@ -0,0 +1,111 @@
+#include "SpriteBatch.h"
+#include "RenderStats.h"
+
+void SpriteBatch::begin() {
+	quads.clear();
+}
+
+//  Queue a whole image centered at "center"
+//
+void SpriteBatch::add(const ImageRegion &img, const ofVec3f &center, float w, float h,
+	float rotation, const ofColor &tint) {
+	const ofTexture *texture = img.isLoaded() ? &img.image.getImage().getTexture() : NULL;
+	add(texture, center, w, h, rotation, img.uv, tint);
+}
+
+//  Queue part of a texture (uv is normalized, 0..1) centered at "center",
+//  rotated by "rotation" degrees.  texture may be NULL for a flat rectangle.
+//
+void SpriteBatch::add(const ofTexture *texture, const ofVec3f &center, float w, float h,
+	float rotation, const ofRectangle &uv, const ofColor &tint) {
+	Quad q;
+	q.texture = texture;
+	q.x = center.x;
+	q.y = center.y;
+	q.w = w;
+	q.h = h;
+	q.rotation = rotation;
+	q.uv = uv;
+	q.tint = tint;
+	quads.push_back(q);
+}
+
+//  Sort by texture and draw each run of quads sharing a texture with a
+//  single call.  stable_sort keeps the original order inside a texture.
+//
+void SpriteBatch::end() {
+	std::stable_sort(quads.begin(), quads.end(), [](const Quad &a, const Quad &b) {
+		return a.texture < b.texture;
+	});
+	int start = 0;
+	for (int i = 1; i <= quads.size(); i++) {
+		if (i == quads.size() || quads[i].texture != quads[start].texture) {
+			flush(start, i);
+			start = i;
+		}
+	}
+	quads.clear();
+}
+
+void SpriteBatch::flush(int begin, int end) {
+	if (begin >= end) return;
+	const ofTexture *texture = quads[begin].texture;
+
+	mesh.clear();
+	mesh.setMode(OF_PRIMITIVE_TRIANGLES);
+	for (int i = begin; i < end; i++) {
+		const Quad &q = quads[i];
+
+		// corners relative to the center, rotated like ofRotate() would
+		//
+		float a = ofDegToRad(q.rotation);
+		float c = cos(a), s = sin(a);
+		float hw = q.w / 2, hh = q.h / 2;
+		float cx[4] = { -hw, hw, hw, -hw };
+		float cy[4] = { -hh, -hh, hh, hh };
+		float u[4] = { q.uv.getLeft(), q.uv.getRight(), q.uv.getRight(), q.uv.getLeft() };
+		float v[4] = { q.uv.getTop(), q.uv.getTop(), q.uv.getBottom(), q.uv.getBottom() };
+
+		ofIndexType base = mesh.getNumVertices();
+		for (int k = 0; k < 4; k++) {
+			mesh.addVertex(glm::vec3(q.x + cx[k] * c - cy[k] * s, q.y + cx[k] * s + cy[k] * c, 0));
+			mesh.addColor(ofFloatColor(q.tint));
+			if (texture) mesh.addTexCoord(texture->getCoordFromPercent(u[k], v[k]));
+		}
+		mesh.addIndex(base);
+		mesh.addIndex(base + 1);
+		mesh.addIndex(base + 2);
+		mesh.addIndex(base);
+		mesh.addIndex(base + 2);
+		mesh.addIndex(base + 3);
+	}
+
+	ofSetColor(ofColor::white);
+	if (texture) texture->bind();
+	mesh.draw();
+	if (texture) texture->unbind();
+
+	renderStats.drawCalls++;
+	renderStats.quads += end - begin;
+}
+
+//  Every sprite of "snap", "alpha" of the way from its previous position.
+//  "images" maps the snapshot's image ids to regions; a sprite with an
+//  image is drawn at the image size with its top left where the entity's
+//  would be.
+//
+void SpriteBatch::addSprites(const RenderSnapshot &snap, const vector<ImageRegion> &images, float alpha) {
+	for (int i = 0; i < snap.sprites.size(); i++) {
+		const RenderSnapshot::Quad &q = snap.sprites[i];
+		ofVec3f center(ofLerp(q.x0, q.x1, alpha), ofLerp(q.y0, q.y1, alpha), 0);
+		if (q.image >= 0 && q.image < images.size() && images[q.image].isLoaded()) {
+			const ImageRegion &img = images[q.image];
+			center.x += (img.width - q.w) / 2;
+			center.y += (img.height - q.h) / 2;
+			add(img, center, img.width, img.height, q.rot);
+		}
+		else {
+			add(NULL, center, q.w, q.h, q.rot, ofRectangle(0, 0, 1, 1), ofColor::ghostWhite);
+		}
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include "ofMain.h"
+#include "TextureAtlas.h"
+#include "RenderSnapshot.h"
+
+//  Collects textured quads from all sprite systems and emitters during a
+//  frame and draws them in as few calls as possible.
+//
+//  Between begin() and end() every add() just records a quad.  end()
+//  sorts the quads by texture (keeping the submission order within each
+//  texture) and issues one mesh draw per texture.  Quads without a texture
+//  are drawn as flat colored rectangles in their own batch.
+//
+class SpriteBatch {
+public:
+	void begin();
+	void add(const ImageRegion &img, const ofVec3f &center, float w, float h,
+		float rotation = 0, const ofColor &tint = ofColor::white);
+	void add(const ofTexture *texture, const ofVec3f &center, float w, float h,
+		float rotation, const ofRectangle &uv, const ofColor &tint);
+	void addSprites(const RenderSnapshot &snap, const vector<ImageRegion> &images, float alpha);
+	void end();
+
+	int getQuadCount() const { return int(quads.size()); }
+
+private:
+	struct Quad {
+		const ofTexture *texture;
+		float x, y, w, h;
+		float rotation;         // degrees about the center
+		ofRectangle uv;         // normalized texture sub-rectangle
+		ofColor tint;
+	};
+	void flush(int begin, int end);
+
+	vector<Quad> quads;
+	ofMesh mesh;
+};
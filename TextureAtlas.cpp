@@ -0,0 +1,157 @@
+#include "TextureAtlas.h"
+#include "AssetManager.h"
+
+ImageRegion::ImageRegion(const ImageHandle &img) {
+	image = img;
+	width = img.getWidth();
+	height = img.getHeight();
+}
+
+static int nextPowerOfTwo(int v) {
+	int p = 1;
+	while (p < v) p *= 2;
+	return p;
+}
+
+//  Shelf pack "inputs" into pages of at most pageSize x pageSize, tallest
+//  images first, with "padding" transparent pixels around each one so
+//  filtering doesn't bleed between neighbours.  Pages are trimmed to the
+//  smallest power of two that holds their contents.
+//
+bool TextureAtlas::pack(vector<Input> &inputs, const string &base, int pageSize, int padding) {
+	struct Placement { int input, page, x, y; };
+	vector<Placement> placed;
+	vector<ofVec2f> pageExtent;     // used width/height of each page
+
+	vector<int> order(inputs.size());
+	for (int i = 0; i < order.size(); i++) order[i] = i;
+	std::sort(order.begin(), order.end(), [&](int a, int b) {
+		return inputs[a].pixels.getHeight() > inputs[b].pixels.getHeight();
+	});
+
+	int page = 0, x = padding, y = padding, shelfHeight = 0;
+	pageExtent.push_back(ofVec2f(0, 0));
+	for (int k = 0; k < order.size(); k++) {
+		const ofPixels &pix = inputs[order[k]].pixels;
+		int w = pix.getWidth(), h = pix.getHeight();
+		if (w + 2 * padding > pageSize || h + 2 * padding > pageSize) {
+			ofLogError("TextureAtlas") << inputs[order[k]].name << " is larger than an atlas page";
+			return false;
+		}
+		if (x + w + padding > pageSize) {       // next shelf
+			x = padding;
+			y += shelfHeight + padding;
+			shelfHeight = 0;
+		}
+		if (y + h + padding > pageSize) {       // next page
+			page++;
+			pageExtent.push_back(ofVec2f(0, 0));
+			x = padding;
+			y = padding;
+			shelfHeight = 0;
+		}
+		Placement p = { order[k], page, x, y };
+		placed.push_back(p);
+		pageExtent[page].x = max(pageExtent[page].x, float(x + w + padding));
+		pageExtent[page].y = max(pageExtent[page].y, float(y + h + padding));
+		x += w + padding;
+		shelfHeight = max(shelfHeight, h);
+	}
+
+	// paste everything into the pages and write them out
+	//
+	ostringstream meta;
+	meta << "# page <index> <file> <width> <height>" << endl;
+	meta << "# region <name> <page> <x> <y> <width> <height>" << endl;
+	string dir = base.substr(0, base.find_last_of('/') + 1);
+	for (int pg = 0; pg < pageExtent.size(); pg++) {
+		int pw = nextPowerOfTwo(pageExtent[pg].x), ph = nextPowerOfTwo(pageExtent[pg].y);
+		ofPixels pixels;
+		pixels.allocate(pw, ph, OF_IMAGE_COLOR_ALPHA);
+		pixels.setColor(ofColor(0, 0, 0, 0));
+		for (int i = 0; i < placed.size(); i++) {
+			if (placed[i].page != pg) continue;
+			inputs[placed[i].input].pixels.pasteInto(pixels, placed[i].x, placed[i].y);
+		}
+		string file = base + "_" + ofToString(pg) + ".png";
+		if (!ofSaveImage(pixels, file)) {
+			ofLogError("TextureAtlas") << "can't write " << file;
+			return false;
+		}
+		meta << "page " << pg << " " << file.substr(dir.size()) << " " << pw << " " << ph << endl;
+	}
+	for (int i = 0; i < placed.size(); i++) {
+		const Input &in = inputs[placed[i].input];
+		meta << "region " << in.name << " " << placed[i].page << " " << placed[i].x << " " << placed[i].y
+			<< " " << in.pixels.getWidth() << " " << in.pixels.getHeight() << endl;
+	}
+
+	string metaText = meta.str();
+	if (!ofBufferToFile(base + ".txt", ofBuffer(metaText.c_str(), metaText.size()))) {
+		ofLogError("TextureAtlas") << "can't write " << base << ".txt";
+		return false;
+	}
+	ofLogNotice("TextureAtlas") << "packed " << placed.size() << " images into " << pageExtent.size() << " page(s)";
+	return true;
+}
+
+//  Read an atlas description written by pack().  Page images come from
+//  the asset manager, so they are only loaded once.  Returns false (and
+//  leaves the atlas empty) if the file is missing or malformed.
+//
+bool TextureAtlas::load(const string &metaPath, AssetManager &assets) {
+	regions.clear();
+	ofBuffer buffer = ofBufferFromFile(metaPath);
+	if (buffer.size() == 0) return false;
+
+	string dir = metaPath.substr(0, metaPath.find_last_of('/') + 1);
+	vector<ImageHandle> pages;
+	vector<ofVec2f> pageSizes;
+	istringstream in(buffer.getText());
+	string line;
+	while (getline(in, line)) {
+		istringstream fields(line);
+		string kind;
+		fields >> kind;
+		if (kind == "page") {
+			int index, w, h;
+			string file;
+			fields >> index >> file >> w >> h;
+			if (fields.fail() || index != pages.size()) break;
+			pages.push_back(assets.getImage(dir + file));
+			pageSizes.push_back(ofVec2f(w, h));
+		}
+		else if (kind == "region") {
+			string name;
+			int pg, x, y, w, h;
+			fields >> name >> pg >> x >> y >> w >> h;
+			if (fields.fail() || pg < 0 || pg >= pages.size()) break;
+			ImageRegion r;
+			r.image = pages[pg];
+			r.uv = ofRectangle(x / pageSizes[pg].x, y / pageSizes[pg].y, w / pageSizes[pg].x, h / pageSizes[pg].y);
+			r.width = w;
+			r.height = h;
+			regions[name] = r;
+		}
+	}
+
+	for (int i = 0; i < pages.size(); i++) {
+		if (!pages[i].isLoaded()) {
+			regions.clear();
+			break;
+		}
+	}
+	if (regions.empty()) {
+		ofLogWarning("TextureAtlas") << "can't use atlas " << metaPath;
+		return false;
+	}
+	return true;
+}
+
+//  Region called "name", or an empty region if there is none
+//
+ImageRegion TextureAtlas::get(const string &name) const {
+	map<string, ImageRegion>::const_iterator it = regions.find(name);
+	if (it == regions.end()) return ImageRegion();
+	return it->second;
+}
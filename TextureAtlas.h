@@ -0,0 +1,46 @@
+#pragma once
+#include "ofMain.h"
+#include "ImageHandle.h"
+
+class AssetManager;
+
+//  Part of an image to draw: the image (usually a shared atlas page), the
+//  normalized sub-rectangle and the size it is drawn at.  A region made
+//  from a plain ImageHandle covers the whole image.
+//
+struct ImageRegion {
+	ImageRegion() {}
+	ImageRegion(const ImageHandle &img);
+	bool isLoaded() const { return image.isLoaded(); }
+
+	ImageHandle image;
+	ofRectangle uv = ofRectangle(0, 0, 1, 1);
+	float width = 0, height = 0;
+};
+
+//  Sprite images baked into one or a few atlas pages.
+//
+//  pack() is the offline step: it takes the sprite images at their final
+//  in-game sizes, shelf packs them into pages, and writes the pages
+//  (<base>_<n>.png) plus a text file of sub-rectangles (<base>.txt).
+//  load() reads that file at runtime; get() then hands out regions by
+//  name, so the game uses one texture for all sprites and never resizes
+//  images at runtime.
+//
+class TextureAtlas {
+public:
+	struct Input {
+		string name;
+		ofPixels pixels;
+	};
+
+	static bool pack(vector<Input> &inputs, const string &base, int pageSize = 1024, int padding = 2);
+
+	bool load(const string &metaPath, AssetManager &assets);
+	bool isLoaded() const { return !regions.empty(); }
+	bool has(const string &name) const { return regions.count(name) > 0; }
+	ImageRegion get(const string &name) const;
+
+private:
+	map<string, ImageRegion> regions;
+};
@@ -0,0 +1,107 @@
+#include "World.h"
+#include "CompactArray.h"
+
+void World::setCapacity(int n) {
+	limit = n;
+	transforms.reserve(n);
+	velocities.reserve(n);
+	lifetimes.reserve(n);
+	sprites.reserve(n);
+	colliders.reserve(n);
+	tags.reserve(n);
+	followers.reserve(n);
+	dead.reserve(n);
+}
+
+void World::clear() {
+	transforms.clear();
+	velocities.clear();
+	lifetimes.clear();
+	sprites.clear();
+	colliders.clear();
+	tags.clear();
+	followers.clear();
+	dead.clear();
+}
+
+//  Add an entity at "position" with default components (not moving,
+//  immortal, no sprite, no collider, no path).  Returns its index, or -1
+//  if the world is at its capacity.
+//
+int World::spawn(Team team, int kind, const ofVec2f &position) {
+	if (limit > 0 && size() >= limit) {
+		refused++;
+		return -1;
+	}
+	Transform t;
+	t.position = position;
+	t.lastPosition = position;
+	transforms.push_back(t);
+	velocities.push_back(ofVec2f(0, 0));
+	lifetimes.push_back(Lifetime());
+	sprites.push_back(Sprite());
+	colliders.push_back(Collider());
+	Tag tag;
+	tag.team = team;
+	tag.kind = kind;
+	tags.push_back(tag);
+	followers.push_back(PathFollower());
+	dead.push_back(0);
+	return size() - 1;
+}
+
+void World::savePositions() {
+	for (int i = 0; i < transforms.size(); i++) {
+		transforms[i].lastPosition = transforms[i].position;
+	}
+}
+
+//  dt is the simulation step in seconds, now the simulation time in ms.
+//  Entities past their lifespan are removed together with any killed
+//  since the last removeMarked(), in one compaction pass.
+//
+void World::update(float dt, float now) {
+	int n = size();
+	for (int i = 0; i < n; i++) {
+		const Lifetime &l = lifetimes[i];
+		if (l.lifespan != -1 && now - l.birthtime > l.lifespan) dead[i] = 1;
+	}
+	removeMarked();
+
+	for (int i = 0; i < transforms.size(); i++) {
+		transforms[i].position += velocities[i] * dt;
+	}
+}
+
+//  Kill every live entity of "team" (and "kind").  Returns how many
+//  were killed; entities already marked dead aren't counted again.
+//
+int World::killTeam(Team team, int kind) {
+	int count = 0;
+	for (int i = 0; i < tags.size(); i++) {
+		if (!dead[i] && tags[i].team == team && (kind == -1 || tags[i].kind == kind)) {
+			dead[i] = 1;
+			count++;
+		}
+	}
+	return count;
+}
+
+//  Remove the killed entities, keeping the others in order.  Returns the
+//  number removed.
+//
+int World::removeMarked() {
+	int n = size();
+	int nDead = 0;
+	for (int i = 0; i < n; i++) nDead += dead[i];
+	if (nDead == 0) return 0;
+	compactArray(transforms, dead);
+	compactArray(velocities, dead);
+	compactArray(lifetimes, dead);
+	compactArray(sprites, dead);
+	compactArray(colliders, dead);
+	compactArray(tags, dead);
+	compactArray(followers, dead);
+	dead.assign(size(), 0);
+	return nDead;
+}
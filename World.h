@@ -0,0 +1,76 @@
+#pragma once
+#include "ofMain.h"
+
+typedef enum { TeamPlayer, TeamMissile, TeamInvader, TeamBonus } Team;
+
+//  Storage for every game object: the ship, missiles, invaders and bonus
+//  pills.
+//
+//  An entity is an index into a set of densely packed component arrays,
+//  all the same length, so systems (movement, expiry, collisions,
+//  drawing) are linear passes over plain arrays instead of walks over
+//  emitters and their sprite systems.  Entities don't refer to each
+//  other, so an index is only good until the next removeMarked(); the
+//  first entity spawned is never removed by the game and keeps index 0.
+//
+//  Removal is a flag (kill()) plus one stable compaction pass, and
+//  setCapacity() sizes every array up front and makes it a hard limit:
+//  spawn() refuses entities past it instead of growing the arrays, so
+//  spawning and removing entities never touches the heap once the world
+//  is sized.
+//
+class World {
+public:
+	struct Transform {
+		ofVec2f position;
+		ofVec2f lastPosition;   // at the start of the tick, drawing interpolates from it
+		float rotation = 0;     // degrees
+	};
+	struct Lifetime {
+		float birthtime = 0;    // ms
+		float lifespan = -1;    // ms, -1 => immortal
+	};
+	struct Sprite {
+		int image = -1;         // sprite image id (see ImageSource), -1: drawn as a flat quad
+		float width = 0, height = 0;    // drawn with its top left at position - size / 2
+	};
+	struct Collider {
+		float radius = 0;       // two entities touch when closer than the sum of their radii
+	};
+	struct Tag {
+		Team team;
+		int kind = 0;           // invader type
+	};
+	struct PathFollower {
+		int path = -1;          // PathEngine table, -1 => moves at its own velocity
+		float distance = 0;     // along the path
+		ofVec2f offset;         // from the path to the entity
+	};
+
+	int size() const { return int(transforms.size()); }
+	int capacity() const { return int(transforms.capacity()); }
+	void setCapacity(int n);                // 0 = no limit
+	void clear();
+	int spawn(Team team, int kind, const ofVec2f &position);    // -1 when full
+
+	void savePositions();                   // start of a tick
+	void update(float dt, float now);       // expire, move and remove killed entities
+	void kill(int i) { dead[i] = 1; }
+	bool isDead(int i) const { return dead[i] != 0; }
+	int killTeam(Team team, int kind = -1); // -1: any kind
+	int removeMarked();
+
+	vector<Transform> transforms;
+	vector<ofVec2f> velocities;             // pixels/sec
+	vector<Lifetime> lifetimes;
+	vector<Sprite> sprites;
+	vector<Collider> colliders;
+	vector<Tag> tags;
+	vector<PathFollower> followers;
+
+	int limit = 0;                          // hard limit on entities, 0 = none
+	int refused = 0;                        // spawns refused at the limit
+
+private:
+	vector<char> dead;
+};
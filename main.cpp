@@ -1,13 +1,191 @@
 #include "ofMain.h"
+#ifndef HEADLESS_ONLY
 #include "ofApp.h"
+#endif
+#include "GameSim.h"
+#include "Benchmark.h"
+#include "CollisionCheck.h"
+#include "InputRecorder.h"
+#include <chrono>
 
+static const int windowWidth = 1334;
+static const int windowHeight = 750;
+
+//  Print the timing and the final state of a run without a window
+//
+static void printRun(const GameSim &sim, int ticks, double ms, int nEvents) {
+	cout << "ticks " << ticks << "  sim time " << sim.clock.getNow() / 1000.0 << " s  wall " << ms << " ms  ("
+		<< (ticks > 0 ? ms * 1000.0 / ticks : 0) << " us/tick)" << endl;
+	cout << "seed " << sim.usedSeed << "  score " << sim.score << "  lives " << sim.gunLife << "  level " << sim.level
+		<< "  gameOver " << sim.gameOver << "  sprites " << sim.getSpriteCount()
+		<< "  particles " << sim.getParticleCount() << "  events " << nEvents << endl;
+}
+
+//  Play "ticks" ticks of scripted input on "sim", recording the input
+//  the way ofApp does.  The script starts the game, holds fire and sweeps
+//  the ship left and right.  Returns the number of game events.
+//
+static int playScript(GameSim &sim, int ticks, InputRecorder &recorder) {
+	auto key = [&](InputType type, int key) {
+		InputEvent e;
+		e.type = type;
+		e.key = key;
+		recorder.record(sim.clock.getTicks(), e);
+		sim.input(e);
+	};
+
+	int nEvents = 0;
+	for (int t = 0; t < ticks; t++) {
+		if (t == 0 || t == 1) key(InputKeyPressed, ' ');      // start the game, then the gun
+		if (t % 240 == 2) key(InputKeyPressed, (t / 240) % 2 ? OF_KEY_RIGHT : OF_KEY_LEFT);
+		if (t % 240 == 120) key(InputKeyReleased, (t / 240) % 2 ? OF_KEY_RIGHT : OF_KEY_LEFT);
+		sim.tick();
+		nEvents += sim.events.size();
+		sim.events.clear();
+	}
+	return nEvents;
+}
+
+//  "--headless <ticks> [seed] [recording]": run the game without a window
+//  or GL context on a window sized play field, with scripted input (see
+//  playScript()), and print the timing and the final state.  Given a
+//  file name it also records the script for --replay.
+//
+static int runHeadless(int ticks, uint64_t seed, const string &recordPath) {
+	GameSim sim;
+	sim.seed = seed;
+	sim.setup(windowWidth, windowHeight);
+	InputRecorder recorder;
+	recorder.start(sim.usedSeed, sim.width, sim.height);
+
+	auto start = std::chrono::steady_clock::now();
+	int nEvents = playScript(sim, ticks, recorder);
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	printRun(sim, ticks, ms, nEvents);
+
+	recorder.finish(sim.clock.getTicks());
+	if (!recordPath.empty() && !recorder.save(recordPath)) return 1;
+	return 0;
+}
+
+//  Play "recording" on a new GameSim.  Returns the number of game events.
+//
+static int replay(GameSim &sim, const InputRecorder &recording) {
+	sim.seed = recording.seed;
+	sim.setup(recording.width, recording.height);
+
+	int nEvents = 0;
+	int next = 0;
+	for (uint64_t t = 0; t < recording.ticks; t++) {
+		while (next < recording.entries.size() && recording.entries[next].tick <= t) {
+			sim.input(recording.entries[next].input);
+			next++;
+		}
+		sim.tick();
+		nEvents += sim.events.size();
+		sim.events.clear();
+	}
+	return nEvents;
+}
+
+//  "--replay <recording>": play a recorded game (see InputRecorder) as
+//  fast as the simulation runs, without a window, and print the timing
+//  and the final state
+//
+static int runReplay(const string &path) {
+	InputRecorder recording;
+	if (!recording.load(path)) return 1;
+
+	GameSim sim;
+	auto start = std::chrono::steady_clock::now();
+	int nEvents = replay(sim, recording);
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	printRun(sim, int(recording.ticks), ms, nEvents);
+	return 0;
+}
+
+//  "--check-replay [ticks] [seed]": play a scripted game, restart (as
+//  Enter does in the app) and record the second game, then replay that
+//  recording on a new GameSim.  Both games must end the same; non zero
+//  exit if they don't.
+//
+static int runReplayCheck(int ticks, uint64_t seed) {
+	GameSim sim;
+	sim.seed = seed;
+	sim.setup(windowWidth, windowHeight);
+	InputRecorder recorder;
+	playScript(sim, ticks, recorder);
+
+	sim.setup(windowWidth, windowHeight);
+	recorder.start(sim.usedSeed, sim.width, sim.height);
+	int nEvents = playScript(sim, ticks, recorder);
+	recorder.finish(sim.clock.getTicks());
+
+	GameSim replayed;
+	int nReplayed = replay(replayed, recorder);
+	printRun(sim, ticks, 0, nEvents);
+	printRun(replayed, ticks, 0, nReplayed);
+	if (replayed.score != sim.score || replayed.gunLife != sim.gunLife || replayed.level != sim.level ||
+		replayed.getSpriteCount() != sim.getSpriteCount() || nReplayed != nEvents) {
+		ofLogError("main") << "the replay of a game recorded after a restart differs";
+		return 1;
+	}
+	cout << "replay matches" << endl;
+	return 0;
+}
+
+//  Built with HEADLESS_ONLY defined this is an entry point for the
+//  simulation alone, for build boxes without a display: it links only
+//  the simulation sources (GameSim, World, Particle, ParticleEmitter,
+//  ParticleSystem, ParticleStore, ParticleIndex, TransformObject,
+//  PathEngine, SpatialGrid, InputRecorder, JobSystem, Profiler,
+//  RenderSnapshot, SimClock, FastRandom, Benchmark, CollisionCheck and
+//  main), none of ofApp, the drawing code (SpriteBatch, ParticleMesh,
+//  TextureAtlas, ImageHandle, BackgroundLayer, AssetManager) or
+//  SimThread, and only has the modes that need no window.
+//
 //========================================================================
-int main() {
-	ofSetupOpenGL(1334, 750, OF_WINDOW);			// <-------- setup the GL context
+int main(int argc, char *argv[]) {
+
+#ifndef HEADLESS_ONLY
+	// "--pack-atlas" bakes the sprite images into data/images/atlas_*.png
+	// and atlas.txt, then exits without opening a window
+	//
+	if (argc > 1 && string(argv[1]) == "--pack-atlas") {
+		return ofApp::packAtlas() ? 0 : 1;
+	}
+#endif
+	// "--bench [filter]" runs the hot path benchmarks, JSON to stdout
+	//
+	if (argc > 1 && string(argv[1]) == "--bench") {
+		return runBenchmarks(argc > 2 ? argv[2] : "");
+	}
+	// "--check-collisions [scenes]" compares the grid collision check with
+	// the brute force one on random scenes, non zero exit on a mismatch
+	//
+	if (argc > 1 && string(argv[1]) == "--check-collisions") {
+		return runCollisionCheck(argc > 2 ? atoi(argv[2]) : 1000);
+	}
+	if (argc > 2 && string(argv[1]) == "--headless") {
+		return runHeadless(atoi(argv[2]), argc > 3 ? strtoull(argv[3], NULL, 10) : 1, argc > 4 ? argv[4] : "");
+	}
+	if (argc > 2 && string(argv[1]) == "--replay") {
+		return runReplay(argv[2]);
+	}
+	if (argc > 1 && string(argv[1]) == "--check-replay") {
+		return runReplayCheck(argc > 2 ? atoi(argv[2]) : 3600, argc > 3 ? strtoull(argv[3], NULL, 10) : 1);
+	}
+
+#ifdef HEADLESS_ONLY
+	cerr << "usage: " << argv[0] << " --headless <ticks> [seed] [recording] | --replay <recording> |" << endl
+		<< "    --check-replay [ticks] [seed] | --bench [filter] | --check-collisions [scenes]" << endl;
+	return 1;
+#else
+	ofSetupOpenGL(windowWidth, windowHeight, OF_WINDOW);			// <-------- setup the GL context
 
 	// this kicks off the running of my app
 	// can be OF_WINDOW or OF_FULLSCREEN
 	// pass in width and height too:
 	ofRunApp(new ofApp());
-
+#endif
 }
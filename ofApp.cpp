@@ -1,782 +1,249 @@
 #include "ofApp.h"
 
-
-
-BaseObject::BaseObject() {
-	trans = ofVec3f(0,0,0);
-	scale = ofVec3f(1, 1, 1);
-	rot = 0;
-}
-
-void BaseObject::setPosition(ofVec3f pos) {
-	trans = pos;
-}
-
-//
-// Basic Sprite Object
-//
-Sprite::Sprite() {
-	speed = 0;
-	velocity = ofVec3f(0, 0, 0);
-	lifespan = -1;      // lifespan of -1 => immortal 
-	birthtime = 0;
-	bSelected = false;
-	haveImage = false;
-	name = "UnamedSprite";
-	width = 40;
-	height = 80;
-}
-
-// Return a sprite's age in milliseconds
-//
-float Sprite::age() {
-	return (ofGetElapsedTimeMillis() - birthtime);
-}
-
-//  Set an image for the sprite. If you don't set one, a rectangle
-//  gets drawn.
+//  Add a layer scrolling down at "speed" pixels/sec.  Layers added later
+//  are drawn on top.
 //
-void Sprite::setImage(ofImage img) {
-	image = img;
+void Background::addLayer(const ImageHandle &img, float speed) {
+	if (!img.isLoaded()) return;
+	layers.push_back(BackgroundLayer());
+	layers.back().setup(img, speed);
 	haveImage = true;
-	width = image.getWidth();
-	height = image.getHeight();
 }
 
-
-//  Render the sprite
-//
-void Sprite::draw() {
-
-	ofSetColor(ofColor::white);
-
-	// draw image centered and add in translation amount
-	//
-	if (haveImage) {
-		image.draw(-width / 2.0 + trans.x, -height / 2.0 + trans.y);
-	}
-	else {
-		// in case no image is supplied, draw something.
-		// 
-		ofSetColor(ofColor::ghostWhite);
-		ofDrawRectangle(-width / 2.0 + trans.x, -height / 2.0 + trans.y, width, height);
-	}
+void Background::update(float dt) {
+	for (int i = 0; i < layers.size(); i++) layers[i].update(dt);
 }
 
-//  Add a Sprite to the Sprite System
-//
-void SpriteSystem::add(Sprite s) {
-	sprites.push_back(s);
-}
-
-// Remove a sprite from the sprite system. Note that this function is not currently
-// used. The typical case is that sprites automatically get removed when the reach
-// their lifespan.
-//
-void SpriteSystem::remove(int i) {
-	sprites.erase(sprites.begin() + i);
-}
-
-// remove all sprites within a given dist of point, return number removed
-//
-int SpriteSystem::removeNear(ofVec3f point, float dist) {
-	vector<Sprite>::iterator s = sprites.begin();
-	vector<Sprite>::iterator tmp;
-	int count = 0;
-
-	while (s != sprites.end()) {
-		ofVec3f v = s->trans - point;
-		if (v.length() < dist) {
-			tmp = sprites.erase(s);
-			count++;
-			s = tmp;
-			if (haveSound) {
-				collideSound.play();
-			}
-		}
-		else s++;
-	}
-	return count;
+void Background::reset() {
+	layers.clear();
+	haveImage = false;
 }
 
-//  Update the SpriteSystem by checking which sprites have exceeded their
-//  lifespan (and deleting).  Also the sprite is moved to it's next
-//  location based on velocity and direction.
+//  Layers only resample when the window size changes
 //
-void SpriteSystem::update() {
-
-	if (sprites.size() == 0) return;
-	vector<Sprite>::iterator s = sprites.begin();
-	vector<Sprite>::iterator tmp;
-
-	// check which sprites have exceed their lifespan and delete
-	// from list.  When deleting multiple objects from a vector while
-	// traversing at the same time, use an iterator.
-	//
-	while (s != sprites.end()) {
-		if (s->lifespan != -1 && s->age() > s->lifespan) {
-//			cout << "deleting sprite: " << s->name << endl;
-			tmp = sprites.erase(s);
-			s = tmp;
-		}
-		else s++;
-	}
-
-	//  Move sprite
-	//
-	for (int i = 0; i < sprites.size(); i++) {
-		sprites[i].trans += sprites[i].velocity / ofGetFrameRate();
+void Background::draw() {
+	PROFILE_SCOPE("draw background");
+	for (int i = 0; i < layers.size(); i++) {
+		layers[i].resize(ofGetWindowWidth(), ofGetWindowHeight());
+		layers[i].draw();
 	}
 }
 
-//  Render all the sprites
-//
-void SpriteSystem::draw() {
-	for (int i = 0; i < sprites.size(); i++) {
-		sprites[i].draw();
-	}
-}
 
-//  Create a new Emitter - needs a SpriteSystem
-//
-Emitter::Emitter(SpriteSystem *spriteSys) {
-	sys = spriteSys;
-	lifespan = -1;    // milliseconds
-	started = false;
-	sys->noChild = noChild;
-	sys->setNo = setNo;
-	lastSpawned = 0;
-	rate = 1;    // sprites/sec
-	haveChildImage = false;
-	haveImage = false;
-	velocity = ofVec3f(100, 100, 0);
-	drawable = true;
-	width = 50;
-	height = 50;
-	childWidth = 10;
-	childHeight = 10;
-}
 
-//  Draw the Emitter if it is drawable. In many cases you would want a hidden emitter
+//  Every sprite image with the size it is drawn at in the game (0 keeps
+//  the file's own size).  packAtlas() bakes these into the atlas at
+//  exactly these sizes, so nothing needs resizing at runtime.
 //
+static const struct {
+	const char *name;
+	const char *path;
+	int width, height;
+} spriteImages[] = {
+	{ "rocket", "images/rocket.png", 0, 0 },
+	{ "missle", "images/missle.png", 0, 0 },
+	{ "pill",   "images/pill.png",   50, 50 },
+	{ "alien1", "images/alien1.png", 50, 50 },
+	{ "alien2", "images/alien2.png", 40, 40 },
+	{ "alien3", "images/alien3.jpg", 50, 50 },
+	{ "alien4", "images/alien4.png", 40, 40 },
+	{ "alien5", "images/alien5.png", 50, 50 },
+};
+
+//  Offline step (run with --pack-atlas): bake the sprite images into
+//  data/images/atlas_<n>.png and atlas.txt.  Needs no window or GL
+//  context, only pixels.  The baked pages are checked in, so run it
+//  again and commit them after changing a sprite image or its size.
 //
-void Emitter::draw() {
-	//rotate the emitter
-	ofPushMatrix();
-	ofTranslate(trans.x, trans.y, 0);//move pivot to centre
-	ofRotate(rot);//rotate from centre
-	ofPushMatrix();
-	ofTranslate(-trans.x, -trans.y, 0);//move back by the centre offset
-	//draw image
-	if (drawable) {
-		if (haveImage) {
-			ofSetColor(ofColor::white);
-			image.draw(-image.getWidth() / 2.0 + trans.x, -image.getHeight() / 2.0 + trans.y);
+bool ofApp::packAtlas() {
+	vector<TextureAtlas::Input> inputs;
+	for (int i = 0; i < sizeof(spriteImages) / sizeof(spriteImages[0]); i++) {
+		TextureAtlas::Input in;
+		in.name = spriteImages[i].name;
+		if (!ofLoadImage(in.pixels, spriteImages[i].path)) {
+			ofLogWarning("ofApp") << "atlas: skipping " << spriteImages[i].path;
+			continue;
+		}
+		in.pixels.setImageType(OF_IMAGE_COLOR_ALPHA);
+		if (spriteImages[i].width > 0) {
+			in.pixels.resize(spriteImages[i].width, spriteImages[i].height);
 		}
+		inputs.push_back(in);
 	}
-	ofPopMatrix();
-	ofPopMatrix();
-	// draw sprite system
-	//
-	sys->draw();
-
-	
+	return TextureAtlas::pack(inputs, "images/atlas");
 }
 
-//  Update the Emitter. If it has been started, spawn new sprites with
-//  initial velocity, lifespan, birthtime.
+//  Image for the sprite called "name": its atlas region if the atlas
+//  is loaded, otherwise the single image file resized to its game size.
 //
-void Emitter::update() {
-	if (!started) {
-		for (int i = 0; i < sys->sprites.size(); i++) {
-			sys->remove(i);
-		}
-	}
-	else {
-		float time = ofGetElapsedTimeMillis();
-		if (setNo) {
-			if (count < noChild) {
-				// spawn a new sprite
-				Sprite sprite;
-				if (haveChildImage) sprite.setImage(childImage);
-				sprite.velocity = velocity;
-				sprite.lifespan = lifespan;
-				sprite.setPosition(trans);
-				sprite.birthtime = time;
-				sprite.width = childWidth;
-				sprite.height = childHeight;
-				sys->add(sprite);
-				count += 1;
-				lastSpawned = time;
-				
-			}
-			
-			
-		}
-		else {
-			
-			if ((time - lastSpawned) > (1000.0 / rate)) {
-				// spawn a new sprite
-				Sprite sprite;
-				if (haveChildImage) sprite.setImage(childImage);
-				sprite.velocity =velocity;
-				sprite.lifespan = lifespan;
-				
-				sprite.birthtime = time;
-				sprite.width = childWidth;
-				sprite.height = childHeight;
-				//sprite starts from the top of the emitter, not in the middle
-				glm::vec3 sprite_pos = glm::normalize(velocity) * 30;
-				sprite.setPosition(trans + sprite_pos);
+ImageRegion ofApp::spriteImage(const string &name) {
+	if (atlas.has(name)) return atlas.get(name);
 
-				sprite.birthtime = time;
-				sys->add(sprite);
-				lastSpawned = time;
-			}
-		}
-		sys->update();
+	for (int i = 0; i < sizeof(spriteImages) / sizeof(spriteImages[0]); i++) {
+		if (name != spriteImages[i].name) continue;
+		ImageHandle img = assets.getImage(spriteImages[i].path);
+		if (spriteImages[i].width > 0) img.resize(spriteImages[i].width, spriteImages[i].height);
+		return ImageRegion(img);
 	}
-	
+	return ImageRegion();
 }
 
-// Start/Stop the emitter.
+//  Id the game uses for the sprite image called "name", -1 if it isn't
+//  loaded
 //
-void Emitter::start() {
-	started = true;
-	lastSpawned = ofGetElapsedTimeMillis();
-	count = 0;
-}
-
-void Emitter::stop() {
-	started = false;
-	
-}
-
-
-void Emitter::setLifespan(float life) {
-	lifespan = life;
-}
-
-void Emitter::setVelocity(ofVec3f v) {
-	velocity = v;
-}
-
-void Emitter::setChildImage(ofImage img) {
-	childImage = img;
-	haveChildImage = true;
-	childWidth = img.getWidth();
-	childHeight = img.getHeight();
-}
-
-void Emitter::setImage(ofImage img) {
-	image = img;
-	haveImage = true;
-	width = img.getWidth();
-	height = img.getHeight();
-}
-
-void Emitter::setRate(float r) {
-	rate = r;
-}
-void Emitter::integrate() {
-	trans += velocity / ofGetFrameRate();
-	velocity += acceleration / ofGetFrameRate();
-	velocity = velocity * damping;
-
-}
-void Background::draw() {
-	if (haveImage) {
-		backgroundImage.resize(ofGetWindowWidth(), ofGetWindowHeight());
-		ofImage bg1 = backgroundImage;
-		backgroundImage.draw(position.x, position.y);
-		
-		bg1.draw(position.x, position.y - ofGetWindowHeight());
+int ofApp::spriteImageId(const string &name) const {
+	for (int i = 0; i < spriteImageRegions.size(); i++) {
+		if (name == spriteImages[i].name) return spriteImageRegions[i].isLoaded() ? i : -1;
 	}
+	return -1;
 }
 
-
-
 //--------------------------------------------------------------
 void ofApp::setup(){
+	float setupStart = ofGetElapsedTimeMillis();
+	simThread.stop();       // on a restart the sim is set up again below
+	saveRecording();        // of the game that just ended
 	ofSetVerticalSync(true);
-	
-	// set up background image
-	if (bg.backgroundImage.load("images/background.png")) {
-		bg.haveImage = true;
-	}
-	bg.position =  ofVec3f(0, 0, 0);
-	
-	
-	//set up background sound
-	backgroundSound.load("sounds/background.mp3");
-	backgroundSound.setLoop(true);
-	backgroundSound.setVolume(0.3f);
-	backgroundSound.play();
-
-	//set up opening sound
-	openingSound.load("sounds/opening.mp3");
-	openingSound.play();
-
-	//set up explosion sound of the ship
-	explSound.load("sounds/blast.mp3");
-
-	levelupSound.load("sounds/up.mp3");
 
-	// set up play area for the turret or ship
-	playarea = ofRectangle(20,20,ofGetWindowWidth()-20, ofGetWindowHeight()-20);
-	
-	
-
-		
-	// Create and setup emitters  
+	// start decoding all images on worker threads while the sounds load.
+	// On a restart everything is already cached and this does nothing.
+	// Sprites come from the packed atlas (see packAtlas()) when there is
+	// one, otherwise from the single image files.
 	//
-	gun = new Emitter(new SpriteSystem());
-	life = new Emitter(new SpriteSystem());
-	alien1 = new Emitter(new SpriteSystem());
-	alien2 = new Emitter(new SpriteSystem());
-	alien3 = new Emitter(new SpriteSystem());
-	alien4 = new Emitter(new SpriteSystem());
-	alien5 = new Emitter(new SpriteSystem());
-	
-	// Set up  the gun/missile launcher
-	// gun image and sound
-	gunImage.load("images/rocket.png");
-	
-	if (gunSound.load("sounds/missle.mp3")) {
-		haveSound = true;
-	}
-	//load missle image
-	if (missleImage.load("images/missle.png")) {
-		missleLoaded = true;
+	if (!atlas.isLoaded()) atlas.load("images/atlas.txt", assets);
+	if (atlas.isLoaded()) {
+		assets.preloadImages({ "images/background.png" });
 	}
 	else {
-		ofLogFatalError("can't load image: missle.png");
-		ofExit();
+		assets.preloadImages({ "images/background.png", "images/rocket.png", "images/missle.png",
+			"images/pill.png", "images/alien1.png", "images/alien2.png", "images/alien3.jpg",
+			"images/alien4.png", "images/alien5.png" });
 	}
-	gunSound.setLoop(true);
-	gunSound.setVolume(0.3f);
-
-	gun->setImage(gunImage);
-	gun->setChildImage(missleImage);
-	gun->setPosition(ofVec3f(ofGetWindowWidth() / 2.0, ofGetWindowHeight(), 0));
-	gun->setVelocity(ofVec3f(0, -1000, 0));
-	gun->ver_velocity = glm::vec3(0, 0, 0);
-	gun->hor_velocity = glm::vec3(0,0, 0);
-	gun->setRate(3);
-	gun->setLifespan(ofGetWindowHeight()); //ms
-	gun->speed = glm::length(gun->ver_velocity);
-	gun->acceleration = glm::vec3(0, 0, 0);
-	gun->damping = 0.99;
-	gun->rot = 0;
-	gun->angle = 0;
 
+	//set up background sound
+	backgroundSound = assets.getSound("sounds/background.mp3");
+	backgroundSound->setLoop(true);
+	backgroundSound->setVolume(0.3f);
+	backgroundSound->play();
 
-	// Set up  the bonus launcher
-	// bonus image and sound
-	pillImage.load("images/pill.png");
-	pillImage.resize(75, 75);
-	
-	dropSound.load("sounds/bonus_drop.mp3");
-	life->drawable = false;
-	life->setChildImage(pillImage);
-	life->childImage.resize(50, 50);
-	life->setPosition(ofVec3f(ofRandom(0,ofGetWindowWidth()), 0, 0));
-	life->setVelocity(ofVec3f(0, 200, 0));
-	life->noChild = 1;
-	life->setNo = true;
-	life->setLifespan(7000); //ms
-	if (life->sys->collideSound.load("sounds/bonus.mp3")) {
-		life->sys->haveSound = true;
-		
-	}
+	//set up opening sound
+	openingSound = assets.getSound("sounds/opening.mp3");
+	openingSound->play();
+
+	//set up explosion sound of the ship and the invaders.  Hits in the
+	//same frame share one blast and at most 4 overlap.
+	//                    path, volume, voices, voice length (sec)
+	explSound = sounds.add(assets, "sounds/blast.mp3", 0.3f, 4, 0.5f);
+	levelupSound = sounds.add(assets, "sounds/up.mp3", 1, 1, 1);
+	gunSound = sounds.add(assets, "sounds/missle.mp3", 0.3f, 1, 0, true);
+	dropSound = sounds.add(assets, "sounds/bonus_drop.mp3", 1, 2, 0.5f);
+	bonusSound = sounds.add(assets, "sounds/bonus.mp3", 1, 2, 0.5f);
+	sounds.stop(gunSound);      // on a restart the gun may still be firing
 
-	// Set up some reasonable parameters for the invader spirtes
-	// invader 1
-	alien1Image.load("images/alien1.png");
-	alien1Image.resize(50,50);
-	alien1->drawable = false;
-	alien1->setPosition(ofVec3f(ofGetWindowWidth() / 2, 10, 0));
-	alien1->setChildImage(alien1Image);
-	alien1->childImage.resize(50, 50);
-	alien1->velocity = glm::vec3(0, 200, 0);
-	alien1->setLifespan(5000);
-	alien1->setRate(currentplaytime / (1000 * 60)*0.1 + 1);
-	alien1->setChildSize(50, 50);
-	if (alien1->sys->collideSound.load("sounds/blast.mp3")) {
-		alien1->sys->haveSound = true;
-		alien1->sys->collideSound.setVolume(0.3f);
-	}
-	// insert to list of invaders
-	aliens.push_back(alien1);
-	
-	// invader 2
-	alien2Image.load("images/alien2.png");
-	alien2->drawable = false; // make emitter itself invisible
- 	alien2->setPosition(ofVec3f(ofGetWindowWidth() / 3, 10, 0));
-	                
-	alien2->setChildImage(alien2Image);
-	alien2->childImage.resize(40, 40);
-	alien2->velocity = glm::vec3(0, 300, 0);
-	alien2->setLifespan(7000);
-	alien2->setRate(currentplaytime/(1000*60)*0.1+0.5);
-	alien2->setChildSize(alien2->childImage.getWidth(), alien2->childImage.getHeight());
-	if (alien2->sys->collideSound.load("sounds/blast.mp3")) {
-		alien2->sys->haveSound = true;
-		alien2->sys->collideSound.setVolume(0.3f);
-	}
-	// insert to list of invaders
-	aliens.push_back(alien2);
-	
-	// invader 3
-	alien3Image.load("images/alien3.png");
-	alien3->drawable = false; // make emitter itself invisible
-	alien3->setPosition(ofVec3f(ofGetWindowWidth(), ofGetWindowHeight()/3, 0));
-	alien3->setChildImage(alien3Image);
-	alien3->childImage.resize(50, 50);
-	alien3->velocity = glm::vec3(0, 400, 0);
-	alien3->setLifespan(7000);
-	alien3->setRate(currentplaytime / (1000 * 60)*0.1 + 0.5);
-	alien3->setChildSize(alien3->childImage.getWidth(), alien3->childImage.getHeight());
-	if (alien3->sys->collideSound.load("sounds/blast.mp3")) {
-		alien3->sys->haveSound = true;
-		alien3->sys->collideSound.setVolume(0.3f);
-	}
-	aliens.push_back(alien3);
-	
-	// invader 4
-	alien4Image.load("images/alien4.png");
-	alien4->drawable = false; // make emitter itself invisible
-	alien4->setPosition(ofVec3f(ofGetWindowWidth() / 3, 10, 0));
+	// set up background image
+	bg.reset();
+	bg.addLayer(assets.getImage("images/background.png"), 36);     // pixels/sec
 
-	alien4->setChildImage(alien4Image);
-	alien4->childImage.resize(40, 40);
-	alien4->velocity = glm::vec3(0, 500, 0);
-	alien4->setLifespan(7000);
-	alien4->setRate(currentplaytime / (1000 * 60)*0.1 + 0.5);
-	alien4->setChildSize(alien4->childImage.getWidth(), alien4->childImage.getHeight());
-	if (alien4->sys->collideSound.load("sounds/blast.mp3")) {
-		alien4->sys->haveSound = true;
-		alien4->sys->collideSound.setVolume(0.3f);
+	spriteImageRegions.clear();
+	for (int i = 0; i < sizeof(spriteImages) / sizeof(spriteImages[0]); i++) {
+		spriteImageRegions.push_back(spriteImage(spriteImages[i].name));
 	}
-	// insert to list of invaders
-	aliens.push_back(alien4);
-
-	// invader 5
-	alien5Image.load("images/alien5.png");
-	alien5->drawable = false; // make emitter itself invisible
-	alien5->setPosition(ofVec3f(0, ofGetWindowHeight()* 2/3, 0));
-	alien5->setChildImage(alien5Image);
-	alien5->childImage.resize(50, 50);
-	alien5->velocity = glm::vec3(0, 400, 0);
-	alien5->setLifespan(7000);
-	alien5->setRate(currentplaytime / (1000 * 60)*0.1 + 0.5);
-	alien5->setChildSize(alien5->childImage.getWidth(), alien5->childImage.getHeight());
-	if (alien5->sys->collideSound.load("sounds/blast.mp3")) {
-		alien5->sys->haveSound = true;
-		alien5->sys->collideSound.setVolume(0.3f);
+	if (spriteImageId("missle") < 0) {
+		ofLogFatalError("can't load image: missle.png");
+		ofExit();
 	}
-	aliens.push_back(alien5);
 
-
-	// set up the emitter forces
+	// the game, on a play field the size of the window
 	//
-	turbForce = new TurbulenceForce(ofVec3f(-20, -20, -20), ofVec3f(20, 20, 20));
-	gravityForce = new GravityForce(ofVec3f(0, -10, 0));
-	radialForce = new ImpulseRadialForce(2000.0);
-
-	// set up the explosion force of invaders
-	
-	expEmit.sys->addForce(turbForce);
-	expEmit.sys->addForce(gravityForce);
-	expEmit.sys->addForce(radialForce);
-
-	expEmit.setPosition(ofVec3f(ofGetWindowWidth()/2, ofGetWindowHeight()/2, 0));
-	expEmit.setOneShot(true);
-	expEmit.setEmitterType(RadialEmitter);
-	expEmit.setGroupSize(50);
-	expEmit.setLifespan(0.5);
-	expEmit.setVelocity(ofVec3f(0, 200, 0));
-	expEmit.setRate(5.0);
-	expEmit.setParticleRadius(1);
-	
-	// set up the explosion effect for the ship
-	
-	expEmitShip.sys->addForce(turbForce);
-	expEmitShip.sys->addForce(gravityForce);
-	expEmitShip.sys->addForce(radialForce);
-
-	expEmitShip.setOneShot(true);
-	expEmitShip.setEmitterType(RadialEmitter);
-	expEmitShip.setGroupSize(100);
-	expEmitShip.setLifespan(1);
-	expEmitShip.setVelocity(ofVec3f(0, 400, 0));
-	expEmitShip.setRate(5.0);
-	expEmitShip.setParticleRadius(2);
-	
-	// set up thruster fire effect for the ship
-	thrusterShip.sys->addForce(turbForce);
-	thrusterShip.sys->addForce(gravityForce);
-	
-	thrusterShip.setPosition(gun->trans);
-	thrusterShip.setEmitterType(DiscEmitter);
-	thrusterShip.setGroupSize(100);
-	thrusterShip.setLifespan(0.5);
-	thrusterShip.setVelocity(ofVec3f(0, 100, 0));
-	thrusterShip.setRate(5.0);
-	thrusterShip.radius = 5;
-	thrusterShip.setParticleRadius(1);
-	thrusterShip.start();
+	sim.setup(ofGetWindowWidth(), ofGetWindowHeight(),
+		[this](const string &name) { return spriteImageId(name); });
 
-	
-	//gui.add(rate.setup("rate", 2, 1, 10));
-	
 	bHide = false;
-	
-	// start program with an idle mode only start when the space bar is pressed the first time
-	startAnim = false;
 	bSpaceDown = false;
-	//gameStartTime = ofGetElapsedTimeMillis();
-	gameOver = false;
-	score = 0; // restart score
-	hit = 0; // restart gun hitted number
-	gunLife = 3; // set player health = 3 lives
-	mouseLast = gun->trans;
-	
-	level = 0;
+	mouseLast = sim.world.transforms[sim.gun].position;
 	instruction = false; // press i to access instruction
+	if (bRecord) recorder.start(sim.usedSeed, sim.width, sim.height);
+	simThread.start(&sim);
+
+	// report how long setup took; on a restart (Enter) this is the
+	// restart latency
+	//
+	setupCount++;
+	ofLogNotice("ofApp") << (setupCount == 1 ? "setup" : "restart") << " took "
+		<< (ofGetElapsedTimeMillis() - setupStart) << " ms";
 }
 
 //--------------------------------------------------------------
+//  The simulation ticks on its own thread; here the background scrolls
+//  with the frame time (smooth at any display rate) and the sounds for
+//  whatever happened since the last frame are played.
+//
 void ofApp::update() {
-	//scrolling background
-	if (startAnim) {
-		if (bg.position.y > ofGetWindowHeight())
-		{
-			bg.position.y = 0;
-		}
-		bg.position.y += 0.01 * ofGetFrameRate();
-		float angle;
-		switch (moveDir)
-		{
-		case MoveUp:
-			move = 1;
-			gun->acceleration =glm::vec3(0,250,0);
-			gun->ver_velocity += gun->acceleration / ofGetFrameRate();
-			gun->trans -= gun->ver_velocity / ofGetFrameRate();
+	PROFILE_SCOPE("update");
+	if (simThread.latest().startAnim) {
+		bg.update(ofGetLastFrameTime());
+	}
+	playEvents();
+
+	// job system utilization for the overlay, once a second
+	//
+	if (ofGetFrameNum() % 60 == 0) {
+		jobStats = jobSystem.getStats();
+		jobSystem.resetStats();
+	}
+}
+
+//  Trigger the sound for each game event since the last frame, then let
+//  the sound bank start the voices (one per effect per frame)
+//
+void ofApp::playEvents() {
+	PROFILE_SCOPE("sounds");
+	simThread.takeEvents(events);
+	for (int i = 0; i < events.size(); i++) {
+		switch (events[i].type) {
+		case EventFireStart:
+			sounds.trigger(gunSound);
 			break;
-		case MoveDown:
-			move = 2;
-			gun->acceleration = glm::vec3(0, 250, 0);
-			gun->ver_velocity += gun->acceleration / ofGetFrameRate();
-			gun->trans += gun->ver_velocity / ofGetFrameRate();
+		case EventFireStop:
+			sounds.stop(gunSound);
 			break;
-		case MoveLeft:
-			move =3;
-			gun->acceleration = glm::vec3(250, 0, 0);
-			gun->hor_velocity += gun->acceleration / ofGetFrameRate();
-			gun->trans -= gun->hor_velocity / ofGetFrameRate();
+		case EventInvaderHit:
+			sounds.trigger(explSound);
 			break;
-		case MoveRight:
-			move = 4;
-			gun->acceleration = glm::vec3(250, 0, 0);
-			gun->hor_velocity += gun->acceleration / ofGetFrameRate();
-			gun->trans += gun->hor_velocity / ofGetFrameRate();
+		case EventBonusPickup:
+			sounds.trigger(bonusSound);
 			break;
-		case MoveStop:
-
-			gun->acceleration = glm::vec3(0, 0, 0);
-			if (glm::length(gun->ver_velocity) >gun->speed) {
-				gun->ver_velocity = gun->ver_velocity * gun->damping;
-				if (move == 1 ) { //move foward
-					gun->trans -=gun->ver_velocity / ofGetFrameRate();
-				}
-				if (move == 2 ) { //move backward
-					gun->trans += gun->ver_velocity / ofGetFrameRate();
-				}
-				
-			}
-			if (glm::length(gun->hor_velocity) > gun->speed) {
-				gun->hor_velocity = gun->hor_velocity * gun->damping;
-				if (move == 3) { //move left
-					gun->trans -= gun->hor_velocity / ofGetFrameRate();
-				}
-				if (move == 4) { //move right
-					gun->trans += gun->hor_velocity / ofGetFrameRate();
-				}
-			}
+		case EventBonusDrop:
+			sounds.trigger(dropSound);
+			break;
+		case EventLevelUp:
+			sounds.trigger(levelupSound);
+			break;
+		case EventShipDestroyed:
+			sounds.trigger(explSound, 1.0f);
 			break;
-		}
-		
-	}
-	
-	
-	// update explosion effects when an invasion is defeated
-	expEmit.update();
-
-	// update explosion effects when gun object is defeated
-	expEmitShip.update();
-
-	// update thruster effect in the tail of the ship as flying up 
-	thrusterShip.update();
-	thrusterShip.setPosition(gun->trans);
-	
-	// update gun velocity as rotate angle, rate as rate in gui 
-	gun->update();
-	
-	
-	// Every 3 level up, the gun rate will increase 15%
-	if (level % 3 == 0) {
-		if (levelup) {
-			gun->rate *= 1.5;
-			levelupSound.play(); // a sound effect play whenever the rate in upgrade
-			levelup = false;
-		}
-	}
-	else {
-		levelup = true;
-	}
-	
-	if (!startAnim) {
-		gun->trans.y -= 3;
-		if (gun->trans.y <= (ofGetWindowHeight() * 2 / 3)) {
-			gun->trans.y = (ofGetWindowHeight() * 2 / 3);
-		}
-	}
-	
-	//set angle of the ship object
-	//ship.angle = fireAngle;
-	
-	//start and update base on level of difficulty 
-	if (startAnim) {
-		if (level <= aliens.size()) {
-			for (int i = 0; i < level; i++) {
-				Emitter *alien = aliens[i];
-				if (alien->started) {
-					alien->update();
-				}
-				else {
-					alien->start();
-				}
-			}
-		}
-		else {
-			for (int i = 0; i < aliens.size(); i++) {
-				Emitter *alien = aliens[i];
-				if (alien->started) {
-					alien->update();
-				}
-				else {
-					alien->start();
-				}
-			}
 		}
 	}
-	
-	
-	// check for collisions between missles and invaders
-	//  
-	checkCollisions();
-
-	
-	// we will randomize initial velocity so that not the invaders
-	
-	
-	// invader 1 update
-	ofVec3f v = alien1->velocity;
-	alien1->setVelocity(ofVec3f(ofRandom(-v.y / 2, v.y / 2), v.y, v.z));
-	alien1->trans.x = ofRandom(0, ofGetWindowWidth());
-	
-	// invader 2 update
-	alien2->trans.x = ofRandom(0, ofGetWindowWidth());
-	for (int i = 0; i < alien2->sys->sprites.size(); i++) {
-		ofVec3f p = alien2->sys->sprites[i].trans;
-		alien2->sys->sprites[i].velocity = 60 * (curveEvaly(p.y + 2,150, 4) - curveEvaly(p.y,150, 4));
-	}
-
-	// invader 3 update
-	alien3->trans.y = ofRandom(0, ofGetWindowHeight() * 3 / 4);
-	for (int i = 0; i < alien3->sys->sprites.size(); i++) {
-		ofVec3f p = alien3->sys->sprites[i].trans;
-		alien3->sys->sprites[i].velocity = 60 * (curveEval(p.x, 100, 4) - curveEval(p.x+2, 100, 4));
-	}
-	
-	// invader 4 update
+	sounds.update(ofGetElapsedTimef());
+}
 
-	for (int i = 0; i < alien4->sys->sprites.size(); i++) {
-		ofVec3f p = alien4->sys->sprites[i].trans;
-		alien4->sys->sprites[i].velocity = 60 * (curveEvaly(p.y + 2, 50, 10) - curveEvaly(p.y, 50, 10));
-	}
 
-	// invader 5 update
-	alien5->trans.y = ofRandom(ofGetWindowHeight()/4, ofGetWindowHeight()*3/4);
-	for (int i = 0; i < alien5->sys->sprites.size(); i++) {
-		ofVec3f p = alien5->sys->sprites[i].trans;
-		alien5->sys->sprites[i].velocity = 60 * (curveEval(p.x + 2, 10, level) - curveEval(p.x, 10, level));
+//--------------------------------------------------------------
+void ofApp::draw(){
+	if (!firstFrameDrawn) {
+		firstFrameDrawn = true;
+		ofLogNotice("ofApp") << "time to first frame: " << ofGetElapsedTimeMillis() << " ms";
 	}
+	lastFrameStats = renderStats;
+	renderStats.reset();
+	PROFILE_SCOPE("draw");
 
-	// game runs until all lives of gun run out
+	// the last tick the sim thread published, drawn "alpha" of the way
+	// from its previous tick
 	//
-	float t = ofGetElapsedTimeMillis();
-	if (startAnim) {
-		if (gunLife == 0) {
-			gunLife = -1;
-			// ship explosion
-			expEmitShip.setPosition(gun->trans);
-			expEmitShip.start();
-			explSound.play();
-			thrusterShip.stop();
-			gun->stop();
-			gunSound.stop();
-
-			//set gameOver
-			gameOver = true;
-
-			playtime = (t - gameStartTime) / 1000;
-
-			// remove all the invaders		
-			aliens.clear();
-
-		}
-	}
-	
-
-	//check for playing area bound
-	if (gun->trans.x < playarea.getLeft()) {
-		gun->trans.x = playarea.getLeft();
-	}
-	else if (gun->trans.x > playarea.getRight()) {
-		gun->trans.x = playarea.getRight();
-	}
-	if (gun->trans.y > playarea.getBottom()) {
-		gun->trans.y = playarea.getBottom();
-	}
-	else if (gun->trans.y < playarea.getTop()) {
-		gun->trans.y = playarea.getTop();
-	}
-
-	// level is calculate as quotient of 20 
-	level = score/10 + 1;
-	if (startAnim) {
-		t = ofGetElapsedTimeMillis();
-		currentplaytime = t - gameStartTime;
-		
-		//set up bonus life
-		life->update();
-		life->setPosition(ofVec3f(ofRandom(0, ofGetWindowWidth()), 0, 0));
-
-		//every 20 seconds there will  be a bonus item drop down
-		if (int(currentplaytime) % 20000 <= 20) {
-			//cout << "current play time" << int(currentplaytime) % 30000 << ";";
-			life->start();
-			dropSound.play();
-		}
-	}
-		
-}
-
+	const RenderSnapshot &snap = simThread.latest();
+	float alpha = simThread.getAlpha(snap);
 
-//--------------------------------------------------------------
-void ofApp::draw(){
 	//draw background image
 	ofSetBackgroundColor(ofColor::black);
 	ofDisableDepthTest();
@@ -785,152 +252,115 @@ void ofApp::draw(){
 	
 	//show path of the invaders
 	if (showPath) {
-		for (int i = 0; i < ofGetHeight(); i++) {
-			ofVec3f p = curveEvaly(i, 100, 4);
-			//p1.y, 0.5, 10
-			ofDrawCircle(p.x, p.y, 1);
+		// debug: number of live images stays constant as sprites are spawned
+		ofSetColor(ofColor::white);
+		ofDrawBitmapStringHighlight("Sprites: " + std::to_string(snap.liveSprites) + " (" + std::to_string(snap.freeSprites) + " free, " +
+			std::to_string(snap.refusedSprites) + " refused)  Images: " +
+			std::to_string(ImageHandle::getLiveCount()) +
+			"  Particle allocs: " + std::to_string(alignedAllocCount.load()), ofPoint(10, 80));
+		ofDrawBitmapStringHighlight("Frame: " + ofToString(ofGetLastFrameTime() * 1000, 2) + " ms  Draw calls: " +
+			std::to_string(lastFrameStats.drawCalls) + "  Quads: " + std::to_string(lastFrameStats.quads), ofPoint(10, 100));
+		string jobText = "Jobs (busy/run/stolen):";
+		for (int i = 0; i < jobStats.size(); i++) {
+			jobText += "  " + ofToString(jobStats[i].utilization * 100, 0) + "%/" + std::to_string(jobStats[i].jobs) +
+				"/" + std::to_string(jobStats[i].steals);
 		}
-		for (int i = 0; i < ofGetWidth(); i++) {
-			ofVec3f p = curveEval(i, 100, 4);
-			//p1.y, 0.5, 10
-			ofDrawCircle(p.x, p.y, 1);
+		ofDrawBitmapStringHighlight(jobText, ofPoint(10, 120));
+		ofDrawBitmapStringHighlight("Tick: " + std::to_string(snap.tick) + "  alpha " + ofToString(alpha, 2), ofPoint(10, 140));
+		ofDrawBitmapStringHighlight("Sounds played/coalesced/dropped: " + std::to_string(sounds.stats.played) + "/" +
+			std::to_string(sounds.stats.coalesced) + "/" + std::to_string(sounds.stats.dropped) +
+			"  blast voices " + std::to_string(sounds.getVoices(explSound)), ofPoint(10, 160));
+
+		// the baked invader paths, one dot per table point
+		if (snap.paths) {
+			for (int k = 0; k < snap.paths->size(); k++) {
+				const vector<ofVec2f> &points = (*snap.paths)[k].points;
+				for (int i = 0; i < points.size(); i++) {
+					ofDrawCircle(points[i].x, points[i].y, 1);
+				}
+			}
 		}
 	}
 	
 	
 	// Display instruction for player to start the game
-	if (!startAnim) {
+	if (!snap.startAnim) {
 		ofSetColor(ofColor::white);
 		ofDrawBitmapStringHighlight("Press spacebar to begin!", ofGetWidth() / 2 - 85, ofGetHeight() / 2 - 50);
 		ofDrawBitmapStringHighlight("Press i for instruction", ofGetWidth() / 2 - 85, ofGetHeight() / 2 - 30);
 	}
 
 	// draw particle emitter to implement the explosion and thruster effect.
-	ofSetColor(ofColor::white);
-	expEmit.draw();
-	expEmitShip.draw();
-	thrusterShip.draw();
+	{
+		PROFILE_SCOPE("draw particles");
+		ofSetColor(ofColor::white);
+		particleMesh.draw(snap, alpha);
+	}
 
 	
-	// draw the invaders
-	if (level <= aliens.size()) {
-		for (int i = 0; i < level; i++) {
-			Emitter *alien = aliens[i];
-			alien->draw();
-		}
-	}
-	else {
-		for (int i = 0; i < aliens.size(); i++) {
-			Emitter *alien = aliens[i];
-			alien->draw();
-		}
+	// all sprites are queued in the batch and drawn together, sorted by
+	// texture, before the text on top
+	//
+	{
+		PROFILE_SCOPE("draw sprites");
+		spriteBatch.begin();
+
+		// the invaders, then the gun and the bonus while the game is on
+		spriteBatch.addSprites(snap, spriteImageRegions, alpha);
+		spriteBatch.end();
 	}
 
 	// The string text for game info
 	string scoreText;
-	scoreText += "Score: " + std::to_string(score);
+	scoreText += "Score: " + std::to_string(snap.score);
 	string lifeText;
-	lifeText += "Lives: " + std::to_string(gunLife);
+	lifeText += "Lives: " + std::to_string(snap.gunLife);
 	
 	// if game is over, draw a label in middle of screen with the High score and level
 	//
-	if (gameOver) {
+	if (snap.gameOver) {
 		
 		ofSetColor(ofColor::white);
 
 		ofDrawBitmapStringHighlight("GAME OVER", ofPoint(ofGetWidth() / 2 - 85, ofGetHeight() / 2 - 50));
-		ofDrawBitmapStringHighlight("Your High Score: "+ std::to_string(score), ofGetWidth() / 2 - 85, ofGetHeight() / 2 - 20);
-		ofDrawBitmapStringHighlight("Your Level: " + std::to_string(level), ofGetWidth() / 2 - 85, ofGetHeight() / 2 +40);
-		ofDrawBitmapStringHighlight("Total play time: " + std::to_string(int(playtime)), ofGetWidth() / 2 - 85, ofGetHeight() / 2 + 60);
+		ofDrawBitmapStringHighlight("Your High Score: "+ std::to_string(snap.score), ofGetWidth() / 2 - 85, ofGetHeight() / 2 - 20);
+		ofDrawBitmapStringHighlight("Your Level: " + std::to_string(snap.level), ofGetWidth() / 2 - 85, ofGetHeight() / 2 +40);
+		ofDrawBitmapStringHighlight("Total play time: " + std::to_string(int(snap.playtime)), ofGetWidth() / 2 - 85, ofGetHeight() / 2 + 60);
 		ofDrawBitmapStringHighlight("Press Enter to start again", ofGetWidth() / 2 - 85, ofGetHeight() / 2 + 80);
 
 	}
 	else {
 		ofSetColor(ofColor::white);
-		gun->draw();
-		life->draw();
 		if (instruction) {
 			ofDrawBitmapStringHighlight("Press space bar to fire\nRelease to stop", ofGetWidth() / 2 - 85, ofGetHeight() / 2 - 50);
 		}
 		
 		// draw current score, lives, level
 		//
-		if (startAnim) {
+		if (snap.startAnim) {
 			ofDrawBitmapStringHighlight(scoreText, ofPoint(10, 20));
 			ofDrawBitmapStringHighlight(lifeText, ofPoint(10, 40));
-			ofDrawBitmapStringHighlight("Level " + std::to_string(level), ofPoint(10, 60));
+			ofDrawBitmapStringHighlight("Level " + std::to_string(snap.level), ofPoint(10, 60));
 		}
 		
 	}
-}
-
-ofVec3f ofApp::curveEval(float x, float scale, float cycles)
-{
-	// x is in screen coordinates and his in [0, WindowWidth]
-	float u = (cycles * x * PI) / ofGetWindowWidth();
-	return (ofVec3f(x, -scale * sin(u) + (ofGetWindowHeight() / 2), 0));
-}
 
-ofVec3f ofApp::curveEvaly(float y, float scale, float cycles)
-{
-	// x is in screen coordinates and his in [0, WindowWidth]
-	float u = (cycles * y * PI) / ofGetWindowHeight();
-	return (ofVec3f(-scale * sin(u) + (ofGetWindowWidth() / 2),y , 0));
-}
-//--------------------------------------------------------------
-
-//  This is a simple O(M x N) collision check
-//  For each missle check to see which invaders you hit and remove them
-//
-void ofApp::checkCollisions() {
-
-	// find the distance at which the two sprites (missles and invaders) will collide
-	// detect a collision when we are within that distance.
+	// recording indicator ('r')
 	//
-	float collisionDist = gun->childHeight / 2 + alien1->childHeight / 2;
-	float life_collisionDist = gun->height / 2 + alien1->childHeight / 2;
-	float bonus_collisionDist = gun->height / 2 + life->childHeight / 2;
-
-	if (life->sys->removeNear(gun->trans, bonus_collisionDist)) {
-		gunLife += 1;
+	if (bRecord) {
+		ofSetColor(ofColor::white);
+		ofDrawBitmapStringHighlight("REC", ofPoint(ofGetWidth() - 40, ofGetHeight() - 20));
 	}
 
-	for (int i = 0; i < aliens.size(); i++) {
-		Emitter *alien = aliens[i];
-		
-		float alien_collisionDist = gun->childHeight / 2 + alien->childHeight / 2;
-		float life_alien_collisionDist = gun->height / 2 + alien->childHeight / 2;
-
-		for (int i = 0; i < gun->sys->sprites.size(); i++) {
-			//score += alien->sys->removeNear(gun->sys->sprites[i].trans, alien_collisionDist);
-			if (alien->sys->removeNear(gun->sys->sprites[i].trans, alien_collisionDist)) {
-				score += 1;
-				expEmit.setPosition(gun->sys->sprites[i].trans);
-				expEmit.start();
-			}
-			
-		}
-		if (alien->sys->removeNear(gun->trans, life_alien_collisionDist)) {
-			gunLife -= 1;
-		}
-		//hit += alien->sys->removeNear(gun->trans, life_alien_collisionDist);
-	}
-	
-	
-	
-	/*
-	// Loop through all the missiles, then remove any invaders that are within
-	// "collisionDist" of the missiles.  the removeNear() function returns the
-	// number of missiles removed.
+	// profiler overlay ('p'), trace capture ('t')
 	//
-	for (int i = 0; i < gun->sys->sprites.size(); i++) {
-		score += invaders->sys->removeNear(gun->sys->sprites[i].trans, collisionDist);
-		
+	if (profiler.enabled) {
+		profiler.getOverlay(profileLines);
+		for (int i = 0; i < profileLines.size(); i++) {
+			ofDrawBitmapStringHighlight(profileLines[i], ofPoint(ofGetWidth() - 440, 20 + 20 * i));
+		}
 	}
-
-	hit += invaders->sys->removeNear(gun->trans, life_collisionDist);
-	*/	
-
+	profiler.endFrame();
 }
 
 //--------------------------------------------------------------
@@ -945,10 +375,12 @@ void ofApp::mouseDragged(int x, int y, int button){
 	glm::vec3 mousePoint(x, y, 0);
 
 	if (bCtrlKeyDown) {
-		gun->rot += x - lastMouse.x;
+		float turn = x - lastMouse.x;
+		sendInput(InputTurn, 0, turn);
 	}
 	else {
-		gun->trans += mousePoint - lastMouse;
+		glm::vec3 move = mousePoint - lastMouse;
+		sendInput(InputDrag, 0, move.x, move.y);
 	}
 	lastMouse = mousePoint;
 }
@@ -989,55 +421,39 @@ void ofApp::keyPressed(int key) {
 		bCtrlKeyDown = true;
 		break;
 	case OF_KEY_UP:
-		moveDir = MoveUp;
-		break;
 	case OF_KEY_DOWN:
-		moveDir = MoveDown;
-		break;
 	case OF_KEY_LEFT:
-		moveDir = MoveLeft;
-		break;
 	case OF_KEY_RIGHT:
-		moveDir = MoveRight;
-		break;
 	case ' ':
-		if (!startAnim) {
-			// Record when the game starts 
-			startAnim = true;
-			gameStartTime = ofGetElapsedTimeMillis();
-			for (int i = 0; i < level; i++) {
-				Emitter *alien = aliens[i];
-				alien->started = true;
-			}
-		}
-	
-		 else if (!gameOver) {
-			if (!gun->started) {
-				gun->started = true;
-				gunSound.play();
-			}
-		}
+	case 'x':
+	case 'm':
+		// game keys, see GameSim::input()
+		sendInput(InputKeyPressed, key);
 		break;
 	case OF_KEY_SHIFT:
 		showPath = !showPath;
 		break;
-	case 'x':
-		gameOver = true;
-		gun->started = false;
-		thrusterShip.stop();
-		aliens.clear();
+	case 'p':
+		profiler.enabled = !profiler.enabled;
+		break;
+	case 't':
+		profiler.startCapture(120);
+		break;
+	case 'r':
+		// record from a fresh game, or stop and save the recording
+		bRecord = !bRecord;
+		if (bRecord) {
+			setup();
+		}
+		else {
+			simThread.stop();
+			saveRecording();
+			simThread.start(&sim);
+		}
 		break;
 	case OF_KEY_RETURN:
 		setup();
 		break;
-	case 'm':
-		life->start();
-		dropSound.play();
-		//expEmit.sys->reset();
-		//expEmit.start();
-		//expEmitShip.start();
-		//thrusterShip.start();
-		break;
 	}
 }
 
@@ -1049,7 +465,7 @@ void ofApp::keyReleased(int key) {
 	case OF_KEY_RIGHT:
 	case OF_KEY_UP:
 	case OF_KEY_DOWN:
-		moveDir = MoveStop;
+		sendInput(InputKeyReleased, key);
 		break;
 	case OF_KEY_ALT:
 		break;
@@ -1059,17 +475,51 @@ void ofApp::keyReleased(int key) {
 		break;
 	case ' ':
 		bSpaceDown = false;
-		gun->started = false;
-		gunSound.stop();
+		sendInput(InputKeyReleased, key);
 		break;
 	}
 }
 
 //--------------------------------------------------------------
 void ofApp::windowResized(int w, int h){
+	sendInput(InputResize, 0, w, h);
 
 }
 
+//--------------------------------------------------------------
+//  Send a game input to the sim thread.  It is recorded there, with the
+//  tick it is applied before, when recording.
+//
+void ofApp::sendInput(InputType type, int key, int x, int y) {
+	InputEvent e;
+	e.type = type;
+	e.key = key;
+	e.x = x;
+	e.y = y;
+	simThread.post([this, e](GameSim &s) {
+		recorder.record(s.clock.getTicks(), e);
+		s.input(e);
+	});
+}
+
+//  End the recording of the current game, if any, and write it out.
+//  The sim thread must be stopped.
+//
+void ofApp::saveRecording() {
+	if (!recorder.recording) return;
+	recorder.finish(sim.clock.getTicks());
+	if (recorder.save(ofToDataPath(recordPath))) {
+		ofLogNotice("ofApp") << "recorded " << recorder.entries.size() << " inputs over " << recorder.ticks
+			<< " ticks to " << recordPath;
+	}
+}
+
+//--------------------------------------------------------------
+void ofApp::exit(){
+	simThread.stop();
+	saveRecording();
+}
+
 //--------------------------------------------------------------
 void ofApp::gotMessage(ofMessage msg){
 
@@ -2,117 +2,37 @@
 
 #include "ofMain.h"
 #include "ofxGui.h"
-#include "ParticleEmitter.h"
-#include "Particle.h"
-#include "ParticleSystem.h"
-#include "TransformObject.h"
-
-
-typedef enum { MoveStop, MoveLeft, MoveRight, MoveUp, MoveDown } MoveDir;
-
-// This is a base object that all drawable object inherit from
-// It is possible this will be replaced by ofNode when we move to 3D
-//
-class BaseObject {
-public:
-	BaseObject();
-	ofVec2f trans, scale;
-	float	rot;
-	bool	bSelected;
-	void setPosition(ofVec3f);
-};
-
-//  General Sprite class  (similar to a Particle)
+#include "ImageHandle.h"
+#include "AssetManager.h"
+#include "RenderStats.h"
+#include "SpriteBatch.h"
+#include "ParticleMesh.h"
+#include "TextureAtlas.h"
+#include "BackgroundLayer.h"
+#include "GameSim.h"
+#include "SimThread.h"
+#include "Profiler.h"
+#include "JobSystem.h"
+#include "InputRecorder.h"
+#include "SoundBank.h"
+
+
+//  Scrolling background made of one or more parallax layers, drawn back
+//  to front
 //
-class Sprite : public BaseObject {
-public:
-	Sprite();
-	void draw();
-	float age();
-	void setImage(ofImage);
-	float speed;    //   in pixels/sec
-	ofVec3f velocity; // in pixels/sec
-	ofImage image;
-	float birthtime; // elapsed time in ms
-	float lifespan;  //  time in ms
-	string name;
-	bool haveImage = false;
-	float width, height;  
-	
-};
-
-//  Manages all Sprites in a system.  You can create multiple systems
-//
-class SpriteSystem  {
-public:
-	void add(Sprite);
-	void remove(int);
-	void update();
-	int removeNear(ofVec3f point, float dist);
-	void draw();
-	vector<Sprite> sprites;
-	ofSoundPlayer collideSound;
-	bool haveSound = false;
-	//vector<Sprite> emitters;
-	int noChild;
-	bool setNo = false;
-};
-
-
-//  General purpose Emitter class for emitting sprites
-//  This works similar to a Particle emitter
-//
-class Emitter: public BaseObject {
-public:
-	Emitter(SpriteSystem *);
-	
-	void draw();
-	void start();
-	void stop();
-	void setLifespan(float);      // in milliseconds
-	void setVelocity(ofVec3f);    // pixel/sec
-	void setChildImage(ofImage);
-	void setChildSize(float w, float h) { childWidth = w; childHeight = h; }
-	void setImage(ofImage);
-	void setRate(float);
-	void update();
-	void integrate();
-	float speed;
-	SpriteSystem *sys; //pointer 
-	float rate;
-	//ofVec3f velocity;
-	float lifespan;
-	bool started;
-	float lastSpawned;
-	ofImage childImage;
-	ofImage image;
-	bool drawable;
-	bool haveChildImage;
-	bool haveImage =false;
-	float width, height;
-	float childWidth, childHeight;
-	int noChild;
-	bool setNo= false;
-	int count=0;
-	glm::vec3 velocity;
-	glm::vec3 ver_velocity;
-	glm::vec3 hor_velocity;
-	glm::vec3 acceleration;
-	float damping;
-	float angle;
-};
-
 class Background {
 	
 public:
 	ofImage home;
-	ofImage backgroundImage;
+	void addLayer(const ImageHandle &img, float speed);
+	void update(float dt);
 	void draw();
+	void reset();
+	vector<BackgroundLayer> layers;
 	bool drawable;
 	bool haveImage = false;
 	bool drawHome = false;
 	float width, height;
-	ofVec3f position;
 	
 
 };
@@ -124,7 +44,7 @@ public:
 	void setup();
 	void update();
 	void draw();
-	void checkCollisions();
+	void playEvents();
 
 	void keyPressed(int key);
 	void keyReleased(int key);
@@ -137,50 +57,63 @@ public:
 	void windowResized(int w, int h);
 	void dragEvent(ofDragInfo dragInfo);
 	void gotMessage(ofMessage msg);
+	void exit();
+
+	void sendInput(InputType type, int key, int x = 0, int y = 0);
+	void saveRecording();
 
 
 	Background bg;
 
-	ofImage defaultImage;
-	ofImage virus1Image;
-	ofImage gunImage;
-	ofImage alien1Image;
-	ofImage alien2Image;
-	ofImage alien3Image;
-	ofImage alien4Image;
-	ofImage alien5Image;
-	ofImage alien6Image;
-	ofImage pillImage;
-	ofImage missleImage;
+	// all images and sounds come from here so they are only loaded once,
+	// even when setup() is run again to restart the game
+	//
+	AssetManager assets;
 
-	
-	ofSoundPlayer gunSound;
-	ofSoundPlayer backgroundSound;
-	ofSoundPlayer openingSound;
-	ofSoundPlayer explSound;
-	ofSoundPlayer dropSound;
-	ofSoundPlayer levelupSound;
-	
-	bool missleLoaded;
-	bool haveSound = false;
-	bool imageLoaded;
-	bool instruction;
-	bool bHide;
-	bool levelup =false;
+	// the game itself; this class only feeds it input, draws it and plays
+	// the sounds for its events.  It ticks on simThread, which hands back
+	// snapshots to draw; input goes through simThread.post().
+	//
+	GameSim sim;
+	SimThread simThread;            // after sim: stopped before sim goes away
+	vector<GameEvent> events;       // taken from simThread each frame
+	ParticleMesh particleMesh;      // particles of the snapshot
+	int setupCount = 0;
+	bool firstFrameDrawn = false;
+	RenderStats lastFrameStats;     // counters of the previous frame for the overlay
+	vector<JobSystem::WorkerStats> jobStats;    // per thread, refreshed every second
+	SpriteBatch spriteBatch;        // all sprites and emitters are drawn through this
+
+	// 'r' records every game from its start to recordPath (in the data
+	// folder) for main.cpp --replay; each restart overwrites it
+	//
+	InputRecorder recorder;
+	bool bRecord = false;
+	string recordPath = "replay.rec";
+
+	// sprite images, packed into one texture when the atlas exists.  The
+	// game refers to them by id, the index in spriteImageRegions.
+	//
+	TextureAtlas atlas;
+	vector<ImageRegion> spriteImageRegions;
+	ImageRegion spriteImage(const string &name);
+	int spriteImageId(const string &name) const;
+	static bool packAtlas();
+	vector<string> profileLines;    // profiler overlay text
 
-	ParticleEmitter expEmit;
-	ParticleEmitter expEmitShip;
-	ParticleEmitter thrusterShip;
 	
+	shared_ptr<ofSoundPlayer> backgroundSound;
+	shared_ptr<ofSoundPlayer> openingSound;
 
-	// adding forces
+	// sound effects, played by playEvents() for the game events
 	//
-	TurbulenceForce *turbForce;
-	GravityForce *gravityForce;
-	ImpulseRadialForce *radialForce;
+	SoundBank sounds;
+	int gunSound, explSound, dropSound, levelupSound, bonusSound;
+	
+	bool instruction;
+	bool bHide;
 
 
-	
 	glm::vec3 lastMouse;   // location of where mouse moved last (when dragging)
 
 	// UI control data
@@ -190,8 +123,6 @@ public:
 	bool bSpaceDown = false;
 	bool bDrag = false;
 
-	bool startAnim = false;
-
 	
 	float headingAngle;
 
@@ -201,26 +132,8 @@ public:
 	
 	
 	ofTrueTypeFont myfont;
-	ofRectangle playarea;
-	ofVec3f curveEval(float x, float scale, float cycles);
-	ofVec3f curveEvaly(float y, float scale, float cycles);
 	bool showPath = false;
-	
-	Emitter *gun;
-	Emitter *life;
-	Emitter *alien1, *alien2 , *alien3, *alien4, *alien5, *alien6;
-	vector<Emitter *> aliens;
-	int hit;
-	int score;
-	int gunLife;
-	int level;
-	float playtime;
-	float gameStartTime;
-	float currentplaytime;
-	bool gameOver = false;
 	ofVec3f mouseLast;
-	MoveDir moveDir;
-	int move = 0;
 
 	
 	